@@ -24,12 +24,33 @@
 #ifndef JSHL_WIGNERSYMBOL_HPP
 #define JSHL_WIGNERSYMBOL_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <type_traits>
 #include <vector>
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+// the batch symbols have an AVX2 kernel, selected at runtime
+#if defined(__x86_64__) && defined(__GNUC__)
+#define JSHL_WIGNER_AVX2
+#include <immintrin.h>
+#endif
 
 namespace util
 {
@@ -42,306 +63,1652 @@ using __ubin_t = uint64_t;
 constexpr int _bin_nmax = 67;
 #endif
 
-class WignerSymbols
+// A double mantissa with a separate exponent, the value is `m * 2^e`.
+// The mantissa is normalized to [0.5, 1) by addition, division and square root. A product of a few numbers is
+// left unnormalized, which is enough for the short products in the symbols and saves most of the cost.
+// The binomial table of `BasicWignerSymbols<xdouble>` never overflows, so the symbols are still correct for large
+// angular momenta (up to the precision lost in the alternating sums), at the price of some speed.
+class xdouble
 {
   public:
-    WignerSymbols() : _nmax(_bin_nmax)
+    xdouble() : m(0), e(0) {}
+    xdouble(double x) : m(x), e(0) { normalize(); }
+    // `m * 2^e`, the mantissa is not normalized
+    static xdouble from_parts(double m, int e)
     {
-        // initialize the data
-        _binomial_data.resize(_binomial_data_size(_nmax), 1);
-        __ubin_t temp[_bin_nmax / 2 + 1];
-        std::fill(temp, temp + _nmax / 2 + 1, __ubin_t(1));
-        std::size_t pos = 1;
-        for (int n = 1; n <= _nmax; ++n)
-        {
-            ++pos;
-            __ubin_t tk1 = 1;
-            for (int k = 1; k <= n / 2; ++k)
-            {
-                __ubin_t x = (2 * k == n) ? 2 * tk1 : temp[k] + tk1;
-                tk1 = temp[k];
-                temp[k] = x;
-                _binomial_data[pos++] = static_cast<double>(x);
-            }
-        }
+        xdouble x;
+        x.m = m;
+        x.e = e;
+        return x;
     }
+    explicit operator double() const { return std::ldexp(m, e); }
 
-    // judge if a number is a odd number
-    static bool isodd(int x) { return x % 2 != 0; }
-    // judge if a number is a even number
-    static bool iseven(int x) { return x % 2 == 0; }
-    // judge if two number are same odd or same even
-    static bool is_same_parity(int x, int y) { return iseven(x ^ y); }
-    // return (-1)^n
-    static int iphase(int x) { return iseven(x) - isodd(x); }
-    // check if m-quantum number if one of the components of a the j-quantum number
-    static bool check_jm(int dj, int dm) { return is_same_parity(dj, dm) && (std::abs(dm) <= dj); }
-    // judge if three angular momentum can couple
-    static bool check_couple(int dj1, int dj2, int dj3)
+    friend xdouble operator-(xdouble a)
     {
-        return dj1 >= 0 && dj2 >= 0 && is_same_parity(dj1 + dj2, dj3) && (dj3 <= (dj1 + dj2)) &&
-               (dj3 >= std::abs(dj1 - dj2));
+        a.m = -a.m;
+        return a;
     }
-    static bool check_couple_int(int j1, int j2, int j3)
+    friend xdouble operator*(xdouble a, xdouble b)
     {
-        return j1 >= 0 && j2 >= 0 && (j3 <= (j1 + j2)) && (j3 >= std::abs(j1 - j2));
+        a.m *= b.m;
+        a.e += b.e;
+        return a;
     }
-    // only works for positive n
-    static double quick_pow(double x, int n)
+    friend xdouble operator/(xdouble a, xdouble b) { return make(a.m / b.m, a.e - b.e); }
+    friend xdouble operator+(xdouble a, xdouble b)
     {
-        double ans = 1;
-        while (n)
-        {
-            if (n & 1)
-                ans = ans * x;
-            n = n >> 1;
-            x = x * x;
-        }
-        return ans;
+        if (a.m == 0)
+            return b;
+        if (b.m == 0)
+            return a;
+        if (a.e < b.e)
+            std::swap(a, b);
+        const int d = a.e - b.e;
+        if (d > 64)
+            return a;
+        return make(a.m + b.m * pow2(-d), a.e);
     }
-
-    double binomial(int n, int k) const
+    friend xdouble operator-(xdouble a, xdouble b) { return a + (-b); }
+    xdouble &operator+=(xdouble b) { return *this = *this + b; }
+    xdouble &operator-=(xdouble b) { return *this = *this - b; }
+    xdouble &operator*=(xdouble b) { return *this = *this * b; }
+    xdouble &operator/=(xdouble b) { return *this = *this / b; }
+    friend xdouble sqrt(xdouble a)
     {
-        if (unsigned(n) > unsigned(_nmax) || unsigned(k) > unsigned(n))
-            return 0;
-        else
+        if (a.e & 1)
         {
-            k = std::min(k, n - k);
-            return _binomial_data[_binomial_index(n, k)];
+            a.m *= 2;
+            a.e -= 1;
         }
+        return make(std::sqrt(a.m), a.e / 2);
     }
 
-    double unsafe_binomial(int n, int k) const
+  private:
+    double m;
+    int e;
+    // 2^d for -1022 <= d <= 1023
+    static double pow2(int d)
     {
-        k = std::min(k, n - k);
-        return _binomial_data[_binomial_index(n, k)];
+        const std::uint64_t bits = std::uint64_t(1023 + d) << 52;
+        double x;
+        std::memcpy(&x, &bits, sizeof(x));
+        return x;
     }
-
-    double CG(int dj1, int dj2, int dj3, int dm1, int dm2, int dm3) const
+    static xdouble make(double m, int e)
     {
-        if (!(check_jm(dj1, dm1) && check_jm(dj2, dm2) && check_jm(dj3, dm3)))
-            return 0;
-        if (!check_couple(dj1, dj2, dj3))
-            return 0;
-        if (dm1 + dm2 != dm3)
-            return 0;
-        const int J = (dj1 + dj2 + dj3) / 2;
-        const int jm1 = J - dj1;
-        const int jm2 = J - dj2;
-        const int jm3 = J - dj3;
-        const int j1mm1 = (dj1 - dm1) / 2;
-        const int j2mm2 = (dj2 - dm2) / 2;
-        const int j3mm3 = (dj3 - dm3) / 2;
-        const int j2pm2 = (dj2 + dm2) / 2;
-        const double A = std::sqrt(unsafe_binomial(dj1, jm2) * unsafe_binomial(dj2, jm3) /
-                                   (unsafe_binomial(J + 1, jm3) * unsafe_binomial(dj1, j1mm1) *
-                                    unsafe_binomial(dj2, j2mm2) * unsafe_binomial(dj3, j3mm3)));
-        double B = 0;
-        const int low = std::max(0, std::max(j1mm1 - jm2, j2pm2 - jm1));
-        const int high = std::min(jm3, std::min(j1mm1, j2pm2));
-        for (auto z = low; z <= high; ++z)
+        xdouble x;
+        x.m = m;
+        x.e = e;
+        x.normalize();
+        return x;
+    }
+    void normalize()
+    {
+        constexpr std::uint64_t exp_mask = std::uint64_t(0x7ff) << 52;
+        std::uint64_t bits;
+        std::memcpy(&bits, &m, sizeof(bits));
+        int ex = int((bits & exp_mask) >> 52);
+        if (ex == 0)
         {
-            B = -B + unsafe_binomial(jm3, z) * unsafe_binomial(jm2, j1mm1 - z) * unsafe_binomial(jm1, j2pm2 - z);
+            if (m == 0)
+            {
+                e = 0;
+                return;
+            }
+            m *= 0x1p64; // subnormal
+            e -= 64;
+            std::memcpy(&bits, &m, sizeof(bits));
+            ex = int((bits & exp_mask) >> 52);
         }
-        return iphase(high) * A * B;
+        bits = (bits & ~exp_mask) | (std::uint64_t(1022) << 52);
+        std::memcpy(&m, &bits, sizeof(m));
+        e += ex - 1022;
     }
+};
 
-    double CG0(int j1, int j2, int j3) const
-    {
-        if (!check_couple_int(j1, j2, j3))
-            return 0;
-        const int J = j1 + j2 + j3;
-        if (isodd(J))
-            return 0;
-        const int g = J / 2;
-        return iphase(g - j3) * unsafe_binomial(g, j3) * unsafe_binomial(j3, g - j1) /
-               std::sqrt(unsafe_binomial(J + 1, 2 * j3 + 1) * unsafe_binomial(2 * j3, J - 2 * j1));
-    }
+// the type returned by the symbols, the extended types only live inside the calculation
+template <typename T>
+struct _wigner_result
+{
+    using type = T;
+};
+
+template <>
+struct _wigner_result<xdouble>
+{
+    using type = double;
+};
 
-    double f3j(int dj1, int dj2, int dj3, int dm1, int dm2, int dm3) const
+// Row `n` of the binomial table holds `binomial(n, k)` for `k = 0..n/2`, the rows are stored one after another.
+constexpr std::size_t _binomial_data_size(int n)
+{
+    std::size_t x = n / 2 + 1;
+    return x * (x + n % 2);
+}
+constexpr std::size_t _binomial_index(int n, int k)
+{
+    std::size_t x = n / 2 + 1;
+    return x * (x - (n % 2 == 0)) + k;
+}
+
+// The default rows `n <= _bin_nmax` are computed at compile time, so they live in the read-only data of the
+// program: the `wigner` object needs no initialization at startup, and the pages are shared between processes.
+template <typename T>
+constexpr void _fill_default_binomial_data(T *data)
+{
+    __ubin_t temp[_bin_nmax / 2 + 1] = {};
+    for (int k = 0; k <= _bin_nmax / 2; ++k)
+        temp[k] = 1;
+    data[0] = 1;
+    std::size_t pos = 1;
+    for (int n = 1; n <= _bin_nmax; ++n)
     {
-        if (!(check_jm(dj1, dm1) && check_jm(dj2, dm2) && check_jm(dj3, dm3)))
-            return 0;
-        if (!check_couple(dj1, dj2, dj3))
-            return 0;
-        if (dm1 + dm2 + dm3 != 0)
-            return 0;
-        const int J = (dj1 + dj2 + dj3) / 2;
-        const int jm1 = J - dj1;
-        const int jm2 = J - dj2;
-        const int jm3 = J - dj3;
-        const int j1mm1 = (dj1 - dm1) / 2;
-        const int j2mm2 = (dj2 - dm2) / 2;
-        const int j3mm3 = (dj3 - dm3) / 2;
-        const int j1pm1 = (dj1 + dm1) / 2;
-        const double A = std::sqrt(unsafe_binomial(dj1, jm2) * unsafe_binomial(dj2, jm1) /
-                                   ((J + 1) * unsafe_binomial(J, jm3) * unsafe_binomial(dj1, j1mm1) *
-                                    unsafe_binomial(dj2, j2mm2) * unsafe_binomial(dj3, j3mm3)));
-        double B = 0;
-        const int low = std::max(0, std::max(j1pm1 - jm2, j2mm2 - jm1));
-        const int high = std::min(jm3, std::min(j1pm1, j2mm2));
-        for (auto z = low; z <= high; ++z)
+        data[pos++] = 1;
+        __ubin_t tk1 = 1;
+        for (int k = 1; k <= n / 2; ++k)
         {
-            B = -B + unsafe_binomial(jm3, z) * unsafe_binomial(jm2, j1pm1 - z) * unsafe_binomial(jm1, j2mm2 - z);
+            __ubin_t x = (2 * k == n) ? 2 * tk1 : temp[k] + tk1;
+            tk1 = temp[k];
+            temp[k] = x;
+            data[pos++] = static_cast<T>(x);
         }
-        return iphase(dj1 + (dj3 + dm3) / 2 + high) * A * B;
     }
+}
+
+template <typename T>
+constexpr std::array<T, _binomial_data_size(_bin_nmax)> _make_default_binomial_data()
+{
+    std::array<T, _binomial_data_size(_bin_nmax)> data{};
+    _fill_default_binomial_data(data.data());
+    return data;
+}
+
+template <typename T>
+inline constexpr std::array<T, _binomial_data_size(_bin_nmax)> _default_binomial_data =
+    _make_default_binomial_data<T>();
+
+template <typename T>
+constexpr std::array<const T *, _bin_nmax + 1> _make_default_binomial_rows()
+{
+    std::array<const T *, _bin_nmax + 1> rows{};
+    for (int n = 0; n <= _bin_nmax; ++n)
+        rows[n] = _default_binomial_data<T>.data() + _binomial_index(n, 0);
+    return rows;
+}
+
+template <typename T>
+inline constexpr std::array<const T *, _bin_nmax + 1> _default_binomial_rows = _make_default_binomial_rows<T>();
+
+// square root of the engine type, `xdouble` is found by ADL
+template <typename T>
+inline T _sqrt(const T &x)
+{
+    using std::sqrt;
+    return sqrt(x);
+}
+
+#ifdef __SIZEOF_FLOAT128__
+// `sqrtq` needs libquadmath, two Newton steps from the `long double` root give the full precision
+inline __float128 _sqrt(const __float128 &x)
+{
+    if (!(x > 0))
+        return 0;
+    __float128 r = std::sqrt(static_cast<long double>(x));
+    r = (r + x / r) / 2;
+    r = (r + x / r) / 2;
+    return r;
+}
+#endif
+
+// absolute value of a result, `std::abs` has no overload for `__float128`
+template <typename T>
+inline T _abs(const T &x)
+{
+    return x < 0 ? -x : x;
+}
+
+// `sqrt((2l1+1)(2l2+1)/(4pi))` of the Gaunt coefficients
+template <typename T>
+inline typename _wigner_result<T>::type _Gaunt_factor(int l1, int l2)
+{
+    constexpr long double pi = 3.141592653589793238462643383279502884L;
+    return static_cast<typename _wigner_result<T>::type>(_sqrt(T((2 * l1 + 1) * (2 * l2 + 1)) / T(4 * pi)));
+}
+
+// `CG_block` and `f3j_range` divide their recursions by this when they grow past it, so the long classically forbidden
+// runs of large j do not overflow, it also leaves room for `float`
+template <typename T>
+inline constexpr T _recursion_big = T(1e15);
+
+// How the large tables are allocated. `huge_pages` asks for transparent huge pages, `numa_node >= 0` prefers the
+// memory of that NUMA node. Both are hints for Linux, on other systems the tables use `operator new`.
+struct TablePolicy
+{
+    bool huge_pages = false;
+    int numa_node = -1;
+};
+
+// number of NUMA nodes, 1 if unknown
+inline int numa_node_count()
+{
+#ifdef __linux__
+    std::ifstream file("/sys/devices/system/node/online");
+    std::string text;
+    if (!(file >> text))
+        return 1;
+    // "0", "0-1" or "0-1,3", the last number is the largest node
+    const std::size_t pos = text.find_last_of("-,");
+    return std::atoi(text.c_str() + (pos == std::string::npos ? 0 : pos + 1)) + 1;
+#else
+    return 1;
+#endif
+}
+
+// NUMA node of the CPU the calling thread runs on, 0 if unknown
+inline int numa_current_node()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+        return static_cast<int>(node);
+#endif
+    return 0;
+}
+
+// The node is read once for each thread, threads that move to another node should call it with `refresh = true`.
+inline int local_numa_node(bool refresh = false)
+{
+    // constant initialized, so the access needs no guard
+    static thread_local int node = -1;
+    if (node < 0 || refresh)
+        node = numa_current_node();
+    return node;
+}
 
-    double f6j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6) const
+struct _table_deleter
+{
+    std::size_t mapped_bytes = 0; // 0 for `operator new`
+    void operator()(void *p) const
     {
-        if (!(check_couple(dj1, dj2, dj3) && check_couple(dj1, dj5, dj6) && check_couple(dj4, dj2, dj6) &&
-              check_couple(dj4, dj5, dj3)))
-            return 0;
-        const int j123 = (dj1 + dj2 + dj3) / 2;
-        const int j156 = (dj1 + dj5 + dj6) / 2;
-        const int j426 = (dj4 + dj2 + dj6) / 2;
-        const int j453 = (dj4 + dj5 + dj3) / 2;
-        const int jpm123 = (dj1 + dj2 - dj3) / 2;
-        const int jpm132 = (dj1 + dj3 - dj2) / 2;
-        const int jpm231 = (dj2 + dj3 - dj1) / 2;
-        const int jpm156 = (dj1 + dj5 - dj6) / 2;
-        const int jpm426 = (dj4 + dj2 - dj6) / 2;
-        const int jpm453 = (dj4 + dj5 - dj3) / 2;
-        const double A = std::sqrt(unsafe_binomial(j123 + 1, dj1 + 1) * unsafe_binomial(dj1, jpm123) /
-                                   (unsafe_binomial(j156 + 1, dj1 + 1) * unsafe_binomial(dj1, jpm156) *
-                                    unsafe_binomial(j453 + 1, dj4 + 1) * unsafe_binomial(dj4, jpm453) *
-                                    unsafe_binomial(j426 + 1, dj4 + 1) * unsafe_binomial(dj4, jpm426)));
-        double B = 0;
-        const int low = std::max(j123, std::max(j156, std::max(j426, j453)));
-        const int high = std::min(jpm123 + j453, std::min(jpm132 + j426, jpm231 + j156));
-        for (auto x = low; x <= high; ++x)
+#ifdef __linux__
+        if (mapped_bytes != 0)
         {
-            B = -B + unsafe_binomial(x + 1, j123 + 1) * unsafe_binomial(jpm123, x - j453) *
-                         unsafe_binomial(jpm132, x - j426) * unsafe_binomial(jpm231, x - j156);
+            munmap(p, mapped_bytes);
+            return;
         }
-        return iphase(high) * A * B / (dj4 + 1);
+#endif
+        ::operator delete(p);
     }
+};
 
-    double Racah(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6) const
-    {
-        return iphase((dj1 + dj2 + dj3 + dj4) / 2) * f6j(dj1, dj2, dj5, dj4, dj3, dj6);
-    }
+template <typename T>
+using _table_ptr = std::unique_ptr<T[], _table_deleter>;
 
-    double f9j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6, int dj7, int dj8, int dj9) const
+// `n` default constructed `T`, the pages are placed by `policy` before they are touched
+template <typename T>
+_table_ptr<T> _allocate_table(std::size_t n, TablePolicy policy)
+{
+    static_assert(std::is_trivially_destructible<T>::value, "table elements are never destroyed");
+    const std::size_t bytes = std::max<std::size_t>(n, 1) * sizeof(T);
+    void *p = nullptr;
+    _table_deleter deleter;
+#ifdef __linux__
+    if (policy.huge_pages || policy.numa_node >= 0)
     {
-        if (!(check_couple(dj1, dj2, dj3) && check_couple(dj4, dj5, dj6) && check_couple(dj7, dj8, dj9) &&
-              check_couple(dj1, dj4, dj7) && check_couple(dj2, dj5, dj8) && check_couple(dj3, dj6, dj9)))
-            return 0;
-        const int j123 = (dj1 + dj2 + dj3) / 2;
-        const int j456 = (dj4 + dj5 + dj6) / 2;
-        const int j789 = (dj7 + dj8 + dj9) / 2;
-        const int j147 = (dj1 + dj4 + dj7) / 2;
-        const int j258 = (dj2 + dj5 + dj8) / 2;
-        const int j369 = (dj3 + dj6 + dj9) / 2;
-        const int pm123 = (dj1 + dj2 - dj3) / 2;
-        const int pm132 = (dj1 + dj3 - dj2) / 2;
-        const int pm231 = (dj2 + dj3 - dj1) / 2;
-        const int pm456 = (dj4 + dj5 - dj6) / 2;
-        const int pm465 = (dj4 + dj6 - dj5) / 2;
-        const int pm564 = (dj5 + dj6 - dj4) / 2;
-        const int pm789 = (dj7 + dj8 - dj9) / 2;
-        const int pm798 = (dj7 + dj9 - dj8) / 2;
-        const int pm897 = (dj8 + dj9 - dj7) / 2;
-        const double P0_nu = unsafe_binomial(j123 + 1, dj1 + 1) * unsafe_binomial(dj1, pm123) * //
-                             unsafe_binomial(j456 + 1, dj5 + 1) * unsafe_binomial(dj5, pm456) * //
-                             unsafe_binomial(j789 + 1, dj9 + 1) * unsafe_binomial(dj9, pm798);
-        const double P0_de = unsafe_binomial(j147 + 1, dj1 + 1) * unsafe_binomial(dj1, (dj1 + dj4 - dj7) / 2) *
-                             unsafe_binomial(j258 + 1, dj5 + 1) * unsafe_binomial(dj5, (dj2 + dj5 - dj8) / 2) *
-                             unsafe_binomial(j369 + 1, dj9 + 1) * unsafe_binomial(dj9, (dj3 + dj9 - dj6) / 2);
-        const double P0 = std::sqrt(P0_nu / P0_de);
-        const int dtl = std::max(std::abs(dj2 - dj6), std::max(std::abs(dj4 - dj8), std::abs(dj1 - dj9)));
-        const int dth = std::min(dj2 + dj6, std::min(dj4 + dj8, dj1 + dj9));
-        double PABC = 0;
-        for (auto dt = dtl; dt <= dth; dt += 2)
+        const std::size_t page = 4096;
+        const std::size_t length = (bytes + page - 1) / page * page;
+        void *q = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (q != MAP_FAILED)
         {
-            const int j19t = (dj1 + dj9 + dt) / 2;
-            const int j26t = (dj2 + dj6 + dt) / 2;
-            const int j48t = (dj4 + dj8 + dt) / 2;
-            double Pt_de = unsafe_binomial(j19t + 1, dt + 1) * unsafe_binomial(dt, (dj1 + dt - dj9) / 2) *
-                           unsafe_binomial(j26t + 1, dt + 1) * unsafe_binomial(dt, (dj2 + dt - dj6) / 2) *
-                           unsafe_binomial(j48t + 1, dt + 1) * unsafe_binomial(dt, (dj4 + dt - dj8) / 2);
-            Pt_de *= (dt + 1) * (dt + 1);
-            const int xl = std::max(j123, std::max(j369, std::max(j26t, j19t)));
-            const int xh = std::min(pm123 + j369, std::min(pm132 + j26t, pm231 + j19t));
-            double At = 0;
-            for (auto x = xl; x <= xh; ++x)
-            {
-                At = -At + unsafe_binomial(x + 1, j123 + 1) * unsafe_binomial(pm123, x - j369) *
-                               unsafe_binomial(pm132, x - j26t) * unsafe_binomial(pm231, x - j19t);
-            }
-            const int yl = std::max(j456, std::max(j26t, std::max(j258, j48t)));
-            const int yh = std::min(pm456 + j26t, std::min(pm465 + j258, pm564 + j48t));
-            double Bt = 0;
-            for (auto y = yl; y <= yh; ++y)
-            {
-                Bt = -Bt + unsafe_binomial(y + 1, j456 + 1) * unsafe_binomial(pm456, y - j26t) *
-                               unsafe_binomial(pm465, y - j258) * unsafe_binomial(pm564, y - j48t);
-            }
-            const int zl = std::max(j789, std::max(j19t, std::max(j48t, j147)));
-            const int zh = std::min(pm789 + j19t, std::min(pm798 + j48t, pm897 + j147));
-            double Ct = 0;
-            for (auto z = zl; z <= zh; ++z)
+#ifdef MADV_HUGEPAGE
+            if (policy.huge_pages)
+                madvise(q, length, MADV_HUGEPAGE);
+#endif
+#if defined(SYS_mbind) && defined(MPOL_PREFERRED)
+            if (policy.numa_node >= 0 && policy.numa_node < 64)
             {
-                Ct = -Ct + unsafe_binomial(z + 1, j789 + 1) * unsafe_binomial(pm789, z - j19t) *
-                               unsafe_binomial(pm798, z - j48t) * unsafe_binomial(pm897, z - j147);
+                unsigned long mask = 1ul << policy.numa_node;
+                syscall(SYS_mbind, q, length, MPOL_PREFERRED, &mask, 64ul, 0u);
             }
-            PABC += iphase(xh + yh + zh) * At * Bt * Ct / Pt_de;
+#endif
+            p = q;
+            deleter.mapped_bytes = length;
         }
-        return iphase(dth) * P0 * PABC;
     }
+#endif
+    if (p == nullptr)
+        p = ::operator new(bytes);
+    T *data = static_cast<T *>(p);
+    std::uninitialized_default_construct_n(data, n);
+    return _table_ptr<T>(data, deleter);
+}
 
-    double norm9j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6, int dj7, int dj8, int dj9)
+// Rows `n = 0..nmax()` holding `k = 0..n/2`, that only grow. The rows live in blocks that are only appended, never
+// moved or freed before destruction, and the row pointers are published with release semantics after the new rows
+// are filled. So readers never take a lock, and a reader holding an old row array still sees valid data while
+// another thread grows the table.
+template <typename T>
+class _triangle_rows
+{
+  public:
+    // starts from the read-only rows `0..nmax`
+    constexpr _triangle_rows(const T *const *rows, int nmax, TablePolicy policy)
+        : _rows(rows), _nmax(nmax), _rows_capacity(0), _policy(policy)
     {
-        return f9j(dj1, dj2, dj3, dj4, dj5, dj6, dj7, dj8, dj9) *
-               std::sqrt((dj3 + 1.) * (dj6 + 1.) * (dj7 + 1.) * (dj8 + 1.));
     }
+    explicit _triangle_rows(TablePolicy policy) : _rows(nullptr), _nmax(-1), _rows_capacity(0), _policy(policy) {}
+    _triangle_rows(const _triangle_rows &) = delete;
+    _triangle_rows &operator=(const _triangle_rows &) = delete;
 
-    static double lsjj(int l1, int l2, int dj1, int dj2, int L, int S, int J)
+    int nmax() const { return _nmax.load(std::memory_order_acquire); }
+    TablePolicy policy() const { return _policy; }
+
+    std::size_t memory() const
     {
-        if (!check_couple(2 * l1, 2 * l2, 2 * L))
-            return 0.0;
-        if (!check_couple(dj1, dj2, 2 * J))
-            return 0.0;
+        const int n = nmax();
+        return _binomial_data_size(n) * sizeof(T) + (n + 1) * sizeof(const T *);
+    }
 
-        int LSJcase = 0;
-        if (S == 0)
+    // no range check, `0 <= n <= nmax()` is required
+    const T *row(int n) const { return _rows.load(std::memory_order_acquire)[n]; }
+    // the row pointers of rows `0..nmax()` at this moment, they stay valid while the table grows
+    const T *const *rows() const { return _rows.load(std::memory_order_acquire); }
+
+    // Only the new rows are computed by `fill(n, row, prev)`, `prev` is row `n - 1` (`nullptr` for `n = 0`), and
+    // appended in a new block. The row pointer array grows geometrically, so calling `grow` with a slowly growing
+    // `nmax` costs O(new rows).
+    template <typename Fill>
+    void grow(int nmax, Fill fill)
+    {
+        if (nmax <= _nmax.load(std::memory_order_acquire))
+            return;
+        std::lock_guard<std::mutex> lock(_grow_mutex);
+        const int old_nmax = _nmax.load(std::memory_order_relaxed);
+        if (nmax <= old_nmax)
+            return;
+        std::size_t reserve_size = _binomial_data_size(nmax);
+        if (reserve_size > std::numeric_limits<int>::max())
         {
-            LSJcase = 1;
+            std::cerr << "Error: nmax too large" << std::endl;
+            std::exit(-1);
         }
-        else if (S == 1)
+        if (!_storage)
+            _storage.reset(new _row_storage);
+        const std::size_t offset = _binomial_index(old_nmax + 1, 0);
+        _table_ptr<T> data = _allocate_table<T>(reserve_size - offset, _policy);
+        const T *const *old_rows = _rows.load(std::memory_order_relaxed);
+        // `_rows_capacity == 0` means there are no rows yet, or they are read-only
+        const T **rows = _rows_capacity == 0 ? nullptr : _storage->tables.back().get();
+        if (nmax + 1 > _rows_capacity)
         {
-            if (L == J - 1)
-                LSJcase = 2;
-            else if (J == L)
-                LSJcase = 3;
-            else if (L == J + 1)
-                LSJcase = 4;
+            _rows_capacity = std::max(nmax + 1, 2 * (old_nmax + 1));
+            _storage->tables.push_back(_allocate_table<const T *>(_rows_capacity, _policy));
+            rows = _storage->tables.back().get();
+            std::copy(old_rows, old_rows + old_nmax + 1, rows);
         }
-        if (LSJcase == 0)
-            return 0.0;
+        const T *prev = old_nmax < 0 ? nullptr : old_rows[old_nmax];
+        for (int n = old_nmax + 1; n <= nmax; ++n)
+        {
+            T *row = data.get() + (_binomial_index(n, 0) - offset);
+            fill(n, row, prev);
+            rows[n] = row;
+            prev = row;
+        }
+        _storage->blocks.push_back(std::move(data));
+        _rows.store(rows, std::memory_order_release);
+        _nmax.store(nmax, std::memory_order_release);
+    }
 
-        const int m = l1 - l2;
-        const int p = l1 + l2;
-        const int d1 = dj1 - 2 * l1;
-        const int d2 = dj2 - 2 * l2;
-        const double den = 2 * (2 * l1 + 1) * (2 * l2 + 1);
-        double r = 0.0;
+  private:
+    struct _row_storage
+    {
+        std::vector<_table_ptr<T>> blocks;
+        std::vector<_table_ptr<const T *>> tables;
+    };
+    std::atomic<const T *const *> _rows;
+    std::atomic<int> _nmax;
+    int _rows_capacity;
+    TablePolicy _policy;
+    std::mutex _grow_mutex;
+    // allocated by the first `grow` beyond the read-only rows
+    std::unique_ptr<_row_storage> _storage;
+};
 
-        if (d1 == 1 && d2 == 1)
-        {
-            if (LSJcase == 1)
-            {
-                r = (J + p + 2) * (p + 1 - J) / den;
-            }
-            else if (LSJcase == 2)
-            {
-                r = (J + m) * (J - m) / static_cast<double>(J * (2 * J + 1));
-                r *= (J + p + 1) * (J + p + 2) / den;
-            }
-            else if (LSJcase == 3)
-            {
-                if (m == 0)
-                    return 0.0;
+// The binomial table, it needs about `nmax^2/4` numbers.
+template <typename T>
+class BinomialTable
+{
+  public:
+    using value_type = T;
+
+    // floating point tables start from the compile time rows, it is a constant initialization
+    template <typename U = T, std::enable_if_t<std::is_floating_point<U>::value, int> = 0>
+    constexpr BinomialTable() : _rows(_default_binomial_rows<T>.data(), _bin_nmax, TablePolicy{})
+    {
+    }
+
+    template <typename U = T, std::enable_if_t<!std::is_floating_point<U>::value, int> = 0>
+    BinomialTable() : BinomialTable(TablePolicy{})
+    {
+    }
+
+    // the default rows are copied into memory allocated by `policy`
+    explicit BinomialTable(TablePolicy policy) : _rows(policy)
+    {
+        std::unique_ptr<T[]> data(new T[_binomial_data_size(_bin_nmax)]);
+        _fill_default_binomial_data(data.get());
+        _rows.grow(_bin_nmax, [&data](int n, T *row, const T *) {
+            std::copy(data.get() + _binomial_index(n, 0), data.get() + _binomial_index(n, n / 2) + 1, row);
+        });
+    }
+
+    BinomialTable(const BinomialTable &other) : BinomialTable(other.policy()) { reserve(other.nmax()); }
+    BinomialTable &operator=(const BinomialTable &) = delete;
+
+    int nmax() const { return _rows.nmax(); }
+    TablePolicy policy() const { return _rows.policy(); }
+
+    // bytes used by the table
+    std::size_t memory() const { return _rows.memory(); }
+
+    // no range check, `0 <= k <= n <= nmax()` is required
+    T operator()(int n, int k) const
+    {
+        k = std::min(k, n - k);
+        return _rows.row(n)[k];
+    }
+
+    // `rows()[n][k]` is `binomial(n, k)` for `k <= n / 2`, for the vectorized symbols
+    const T *const *rows() const { return _rows.rows(); }
+
+    // each new row is computed from the previous one
+    void reserve(int nmax)
+    {
+        _rows.grow(nmax, [](int n, T *row, const T *prev) {
+            row[0] = 1;
+            for (int k = 1; k <= n / 2; ++k)
+            {
+                row[k] = prev[k - 1] + prev[std::min(k, n - 1 - k)];
+            }
+        });
+    }
+
+  private:
+    _triangle_rows<T> _rows;
+};
+
+// `BinomialTable` with two companion tables of `sqrt(binomial(n, k))` and `1/sqrt(binomial(n, k))`, the symbols
+// then compute their prefactors as products of lookups, without square roots and divisions. It needs 3 times the
+// memory of `BinomialTable`.
+template <typename T>
+class SqrtBinomialTable
+{
+  public:
+    using value_type = T;
+
+    SqrtBinomialTable() : _sqrt_rows(TablePolicy{}), _inv_sqrt_rows(TablePolicy{})
+    {
+        _grow_companions(_binomial.nmax());
+    }
+    explicit SqrtBinomialTable(TablePolicy policy) : _binomial(policy), _sqrt_rows(policy), _inv_sqrt_rows(policy)
+    {
+        _grow_companions(_binomial.nmax());
+    }
+    SqrtBinomialTable(const SqrtBinomialTable &other) : SqrtBinomialTable(other.policy()) { reserve(other.nmax()); }
+    SqrtBinomialTable &operator=(const SqrtBinomialTable &) = delete;
+
+    // the companion tables grow after the binomials, so when the last one has `nmax`, all of them have
+    int nmax() const { return _inv_sqrt_rows.nmax(); }
+    TablePolicy policy() const { return _binomial.policy(); }
+
+    std::size_t memory() const { return _binomial.memory() + _sqrt_rows.memory() + _inv_sqrt_rows.memory(); }
+
+    // no range check, `0 <= k <= n <= nmax()` is required
+    T operator()(int n, int k) const { return _binomial(n, k); }
+    T sqrt_binomial(int n, int k) const { return _sqrt_rows.row(n)[std::min(k, n - k)]; }
+    T inv_sqrt_binomial(int n, int k) const { return _inv_sqrt_rows.row(n)[std::min(k, n - k)]; }
+
+    void reserve(int nmax)
+    {
+        _binomial.reserve(nmax);
+        _grow_companions(nmax);
+    }
+
+  private:
+    void _grow_companions(int nmax)
+    {
+        _sqrt_rows.grow(nmax, [this](int n, T *row, const T *) {
+            for (int k = 0; k <= n / 2; ++k)
+                row[k] = _sqrt(_binomial(n, k));
+        });
+        _inv_sqrt_rows.grow(nmax, [this](int n, T *row, const T *) {
+            for (int k = 0; k <= n / 2; ++k)
+                row[k] = T(1) / _sqrt(_binomial(n, k));
+        });
+    }
+
+    BinomialTable<T> _binomial;
+    _triangle_rows<T> _sqrt_rows;
+    _triangle_rows<T> _inv_sqrt_rows;
+};
+
+// if the engine exposes its rows, see `BinomialTable::rows`
+template <typename Binomial, typename = void>
+struct _has_binomial_rows : std::false_type
+{
+};
+
+template <typename Binomial>
+struct _has_binomial_rows<Binomial, decltype(void(std::declval<const Binomial &>().rows()))> : std::true_type
+{
+};
+
+// if the engine has the companion square root tables
+template <typename Binomial, typename = void>
+struct _has_sqrt_binomial : std::false_type
+{
+};
+
+template <typename Binomial>
+struct _has_sqrt_binomial<Binomial, decltype(void(std::declval<const Binomial &>().inv_sqrt_binomial(0, 0)))>
+    : std::true_type
+{
+};
+
+// if the engine has a table local to the calling thread, see `NumaBinomialTable::local`
+template <typename Binomial, typename = void>
+struct _has_local_binomial : std::false_type
+{
+};
+
+template <typename Binomial>
+struct _has_local_binomial<Binomial, decltype(void(std::declval<const Binomial &>().local()))> : std::true_type
+{
+};
+
+// One `BinomialTable` replica on each NUMA node, the lookups use the replica of the calling thread's node.
+template <typename T>
+class NumaBinomialTable
+{
+  public:
+    using value_type = T;
+
+    NumaBinomialTable() : NumaBinomialTable(TablePolicy{}) {}
+    // `policy.numa_node` is ignored, every node gets a replica
+    explicit NumaBinomialTable(TablePolicy policy)
+    {
+        const int nodes = numa_node_count();
+        for (int node = 0; node < nodes; ++node)
+        {
+            policy.numa_node = node;
+            _replicas.emplace_back(new BinomialTable<T>(policy));
+        }
+    }
+    NumaBinomialTable(const NumaBinomialTable &other) : NumaBinomialTable(other._replicas.front()->policy())
+    {
+        reserve(other.nmax());
+    }
+    NumaBinomialTable &operator=(const NumaBinomialTable &) = delete;
+
+    // `reserve` grows the replicas in order, so when the last one has `nmax`, all of them have
+    int nmax() const { return _replicas.back()->nmax(); }
+
+    std::size_t memory() const
+    {
+        std::size_t bytes = 0;
+        for (const auto &replica : _replicas)
+            bytes += replica->memory();
+        return bytes;
+    }
+
+    // The replica of the calling thread's node. The symbols take it once for each call and read the binomials from
+    // it, `operator()` resolves the node for each lookup.
+    const BinomialTable<T> &local() const
+    {
+        const int node = local_numa_node();
+        return *_replicas[unsigned(node) < _replicas.size() ? node : 0];
+    }
+
+    T operator()(int n, int k) const { return local()(n, k); }
+
+    void reserve(int nmax)
+    {
+        for (auto &replica : _replicas)
+            replica->reserve(nmax);
+    }
+
+  private:
+    std::vector<std::unique_ptr<BinomialTable<T>>> _replicas;
+};
+
+// `m * 2^e` converted to `T`, `m` only has the `double` precision
+template <typename T>
+inline T _scale2(double m, int e)
+{
+    return static_cast<T>(std::ldexp(static_cast<long double>(m), e));
+}
+
+template <>
+inline double _scale2<double>(double m, int e)
+{
+    // e > 1023 gives `inf` like an overflowed binomial table, a binomial is never smaller than 1
+    const std::uint64_t bits = std::uint64_t(std::min(e, 1024) + 1023) << 52;
+    double x;
+    std::memcpy(&x, &bits, sizeof(x));
+    return m * x;
+}
+
+template <>
+inline xdouble _scale2<xdouble>(double m, int e)
+{
+    return xdouble::from_parts(m, e);
+}
+
+// Stores `n!` and `1/n!` as a double mantissa with an int exponent, so it only needs O(nmax) memory, and the
+// factorials never overflow. `binomial(n, k) = n! * (1/k!) * (1/(n-k)!)` costs two multiplies.
+// The values are rounded from double-double products, the binomials have a relative error of a few ulp.
+template <typename T>
+class FactorialTable
+{
+  public:
+    using value_type = T;
+
+    FactorialTable() : _data(nullptr), _nmax(-1), _capacity(0), _f{1, 0, 0}, _g{1, 0, 0} { reserve(_bin_nmax); }
+    FactorialTable(const FactorialTable &other) : FactorialTable() { reserve(other.nmax()); }
+    FactorialTable &operator=(const FactorialTable &) = delete;
+
+    int nmax() const { return _nmax.load(std::memory_order_acquire); }
+
+    // bytes used by the table
+    std::size_t memory() const { return (nmax() + 1) * sizeof(_entry); }
+
+    // no range check, `0 <= k <= n <= nmax()` is required
+    T operator()(int n, int k) const
+    {
+        const _entry *f = _data.load(std::memory_order_acquire);
+        return _scale2<T>(f[n].m * f[k].rm * f[n - k].rm, f[n].e + f[k].re + f[n - k].re);
+    }
+
+    // The entries are appended in place when the capacity is enough, otherwise they are copied (O(nmax)) into a
+    // new array, the old array is kept alive for the readers.
+    void reserve(int nmax)
+    {
+        if (nmax <= _nmax.load(std::memory_order_acquire))
+            return;
+        std::lock_guard<std::mutex> lock(_grow_mutex);
+        const int old_nmax = _nmax.load(std::memory_order_relaxed);
+        if (nmax <= old_nmax)
+            return;
+        _entry *data = _blocks.empty() ? nullptr : _blocks.back().get();
+        if (nmax + 1 > _capacity)
+        {
+            _capacity = std::max(nmax + 1, 2 * _capacity);
+            _blocks.emplace_back(new _entry[_capacity]);
+            if (data != nullptr)
+                std::copy(data, data + old_nmax + 1, _blocks.back().get());
+            data = _blocks.back().get();
+        }
+        for (int n = old_nmax + 1; n <= nmax; ++n)
+        {
+            if (n > 0)
+            {
+                _f.mul(n);
+                _g.div(n);
+            }
+            data[n] = {_f.hi + _f.lo, _g.hi + _g.lo, _f.e, _g.e};
+        }
+        _data.store(data, std::memory_order_release);
+        _nmax.store(nmax, std::memory_order_release);
+    }
+
+  private:
+    struct _entry
+    {
+        double m, rm;
+        int e, re;
+    };
+    // (hi + lo) * 2^e
+    struct _dd
+    {
+        double hi, lo;
+        int e;
+        void mul(int n)
+        {
+            const double p = hi * n;
+            const double err = std::fma(hi, n, -p);
+            fast_two_sum(p, lo * n + err);
+            normalize();
+        }
+        void div(int n)
+        {
+            const double q1 = hi / n;
+            const double r = std::fma(-q1, n, hi) + lo;
+            fast_two_sum(q1, r / n);
+            normalize();
+        }
+        void fast_two_sum(double a, double b)
+        {
+            hi = a + b;
+            lo = b - (hi - a);
+        }
+        void normalize()
+        {
+            int k;
+            hi = std::frexp(hi, &k);
+            lo = std::ldexp(lo, -k);
+            e += k;
+        }
+    };
+    std::atomic<const _entry *> _data;
+    std::atomic<int> _nmax;
+    int _capacity;
+    _dd _f, _g;
+    std::mutex _grow_mutex;
+    std::vector<std::unique_ptr<_entry[]>> _blocks;
+};
+
+// A bitmap of the triads `(dj1, dj2, dj3)` that can couple, for `0 <= dj < dim` where `dim` is a power of two, so
+// a lookup is one load and one bit test. Triads outside the bitmap are checked directly. A larger bitmap is built
+// aside and published with release semantics, the old ones are kept until destruction, so readers never take a lock.
+class TriangleTable
+{
+  public:
+    // `dim` is at most 256, which is 2 MB, larger `dj` fall back to the direct check
+    static constexpr int max_djmax = 255;
+
+    constexpr TriangleTable() : TriangleTable(TablePolicy{}) {}
+    constexpr explicit TriangleTable(TablePolicy policy) : _data(_empty), _policy(policy) {}
+    TriangleTable(const TriangleTable &other) : TriangleTable(other.policy()) { reserve(other.djmax()); }
+    TriangleTable &operator=(const TriangleTable &) = delete;
+
+    // the largest `dj` in the bitmap, -1 if it is empty
+    int djmax() const { return static_cast<int>(_data.load(std::memory_order_acquire)[0]) - 1; }
+    TablePolicy policy() const { return _policy; }
+
+    std::size_t memory() const
+    {
+        const std::uint64_t dim = _data.load(std::memory_order_acquire)[0];
+        return dim == 0 ? 0 : (2 + dim * dim * dim / 64) * sizeof(std::uint64_t);
+    }
+
+    // The bitmap at one moment, a loop over many triads loads the pointer once.
+    class view
+    {
+      public:
+        explicit view(const std::uint64_t *data) : _data(data), _dim(data[0]), _shift(unsigned(data[1])) {}
+
+        // judge if three angular momentum can couple
+        bool operator()(int dj1, int dj2, int dj3) const
+        {
+            // `dim` is a power of two, so this also rejects negative arguments
+            if (static_cast<unsigned>(dj1 | dj2 | dj3) < _dim)
+            {
+                const std::uint64_t i = (((std::uint64_t(dj1) << _shift) | unsigned(dj2)) << _shift) | unsigned(dj3);
+                return (_data[2 + (i >> 6)] >> (i & 63)) & 1;
+            }
+            return check(dj1, dj2, dj3);
+        }
+
+      private:
+        const std::uint64_t *_data;
+        std::uint64_t _dim;
+        unsigned _shift;
+    };
+
+    view snapshot() const { return view(_data.load(std::memory_order_acquire)); }
+    bool operator()(int dj1, int dj2, int dj3) const { return snapshot()(dj1, dj2, dj3); }
+
+    static bool check(int dj1, int dj2, int dj3)
+    {
+        return dj1 >= 0 && dj2 >= 0 && ((dj1 + dj2 + dj3) % 2 == 0) && (dj3 <= (dj1 + dj2)) &&
+               (dj3 >= std::abs(dj1 - dj2));
+    }
+
+    // the table stops at `max_djmax`, so a larger `djmax` is clamped before the check, or every call would lock
+    void reserve(int djmax)
+    {
+        djmax = std::min(djmax, max_djmax);
+        if (djmax <= this->djmax())
+            return;
+        std::lock_guard<std::mutex> lock(_grow_mutex);
+        int shift = 3;
+        while ((1 << shift) <= djmax)
+            ++shift;
+        const std::uint64_t dim = std::uint64_t(1) << shift;
+        if (dim <= _data.load(std::memory_order_relaxed)[0])
+            return;
+        const std::size_t size = 2 + dim * dim * dim / 64;
+        _table_ptr<std::uint64_t> data = _allocate_table<std::uint64_t>(size, _policy);
+        std::fill(data.get(), data.get() + size, std::uint64_t(0));
+        data[0] = dim;
+        data[1] = shift;
+        const int n = static_cast<int>(dim);
+        for (int dj1 = 0; dj1 < n; ++dj1)
+        {
+            for (int dj2 = 0; dj2 < n; ++dj2)
+            {
+                const std::uint64_t row = ((std::uint64_t(dj1) << shift) | unsigned(dj2)) << shift;
+                for (int dj3 = std::abs(dj1 - dj2); dj3 <= std::min(dj1 + dj2, n - 1); dj3 += 2)
+                {
+                    const std::uint64_t i = row | unsigned(dj3);
+                    data[2 + (i >> 6)] |= std::uint64_t(1) << (i & 63);
+                }
+            }
+        }
+        if (!_blocks)
+            _blocks.reset(new std::vector<_table_ptr<std::uint64_t>>);
+        _blocks->push_back(std::move(data));
+        _data.store(_blocks->back().get(), std::memory_order_release);
+    }
+
+  private:
+    // `{dim, shift}` of the empty bitmap
+    static constexpr std::uint64_t _empty[2] = {0, 0};
+
+    std::atomic<const std::uint64_t *> _data; // `{dim, shift, bits...}`
+    TablePolicy _policy;
+    std::mutex _grow_mutex;
+    // allocated by the first `reserve`
+    std::unique_ptr<std::vector<_table_ptr<std::uint64_t>>> _blocks;
+};
+
+// The CG coefficients `CG0(j1, j2, j3)` for `j1, j2 <= jmax()`. Only the `j3` with even `j1 + j2 + j3` are stored,
+// and only `j1 >= j2`, since then `CG0(j2, j1, j3) = CG0(j1, j2, j3)`. The row of `(j1, j2)` starts at
+// `j1 (j1 + 1) (j1 + 2) / 6 + j2 (j2 + 1) / 2` and holds `j3 = j1 - j2, j1 - j2 + 2, ..., j1 + j2`, so the table has
+// `(jmax + 1) (jmax + 2) (jmax + 3) / 6` numbers, 3.6KB of double for `jmax = 12`. A larger table is filled aside and
+// published with release semantics, the old ones are kept until destruction, so readers never take a lock.
+template <typename T>
+class CG0Table
+{
+  public:
+    constexpr CG0Table() : CG0Table(TablePolicy{}) {}
+    constexpr explicit CG0Table(TablePolicy policy) : _data(&_empty), _policy(policy) {}
+    CG0Table(const CG0Table &other) : CG0Table(other.policy())
+    {
+        reserve(other.jmax(), [&other](int j1, int j2, T *row) {
+            const T *x = other.row(j1, j2);
+            std::copy(x, x + j2 + 1, row);
+        });
+    }
+    CG0Table &operator=(const CG0Table &) = delete;
+
+    // the largest `j1, j2` in the table, -1 if it is empty
+    int jmax() const { return _data.load(std::memory_order_acquire)->jmax; }
+    TablePolicy policy() const { return _policy; }
+
+    static std::size_t size(int jmax) { return std::size_t(jmax + 1) * (jmax + 2) * (jmax + 3) / 6; }
+    std::size_t memory() const { return size(jmax()) * sizeof(T); }
+
+    // The row of `j1, j2 >= 0`, `nullptr` if it is not in the table. `row(j1, j2)[(j3 - |j1 - j2|) / 2]` is
+    // `CG0(j1, j2, j3)` for `j3 = |j1 - j2|, |j1 - j2| + 2, ..., j1 + j2`, that is `min(j1, j2) + 1` numbers.
+    const T *row(int j1, int j2) const
+    {
+        const _table *table = _data.load(std::memory_order_acquire);
+        if (std::max(j1, j2) > table->jmax)
+            return nullptr;
+        const std::size_t a = std::max(j1, j2), b = std::min(j1, j2);
+        return table->values + (a * (a + 1) * (a + 2) / 6 + b * (b + 1) / 2);
+    }
+
+    // `fill(j1, j2, row)` computes the `j2 + 1` numbers of the row `j1 >= j2`, only the new rows are computed and the
+    // old ones are copied.
+    template <typename Fill>
+    void reserve(int jmax, Fill fill)
+    {
+        if (jmax <= this->jmax())
+            return;
+        std::lock_guard<std::mutex> lock(_grow_mutex);
+        const _table *old = _data.load(std::memory_order_relaxed);
+        if (jmax <= old->jmax)
+            return;
+        if (size(jmax) > std::size_t(std::numeric_limits<int>::max()))
+        {
+            std::cerr << "Error: jmax too large" << std::endl;
+            std::exit(-1);
+        }
+        std::unique_ptr<_block> block(new _block{{jmax, nullptr}, _allocate_table<T>(size(jmax), _policy)});
+        T *values = block->values.get();
+        const std::size_t n_old = old->jmax < 0 ? 0 : size(old->jmax);
+        std::copy(old->values, old->values + n_old, values);
+        for (int j1 = old->jmax + 1; j1 <= jmax; ++j1)
+            for (int j2 = 0; j2 <= j1; ++j2)
+                fill(j1, j2, values + size(j1 - 1) + std::size_t(j2) * (j2 + 1) / 2);
+        block->table.values = values;
+        if (!_blocks)
+            _blocks.reset(new std::vector<std::unique_ptr<_block>>);
+        _blocks->push_back(std::move(block));
+        _data.store(&_blocks->back()->table, std::memory_order_release);
+    }
+
+  private:
+    struct _table
+    {
+        int jmax;
+        const T *values;
+    };
+    struct _block
+    {
+        _table table;
+        _table_ptr<T> values;
+    };
+
+    static constexpr _table _empty{-1, nullptr};
+
+    std::atomic<const _table *> _data;
+    TablePolicy _policy;
+    std::mutex _grow_mutex;
+    // allocated by the first `reserve`
+    std::unique_ptr<std::vector<std::unique_ptr<_block>>> _blocks;
+};
+
+#ifdef JSHL_WIGNER_AVX2
+// the 4 lane operations of `BasicWignerSymbols::_batch_avx2`
+struct _avx2_ops
+{
+    __attribute__((target("avx2"))) static __m128i load(const int *p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    }
+    // `x <= y` of each lane
+    __attribute__((target("avx2"))) static __m128i le(__m128i x, __m128i y)
+    {
+        return _mm_xor_si128(_mm_cmpgt_epi32(x, y), _mm_set1_epi32(-1));
+    }
+    __attribute__((target("avx2"))) static __m128i even(__m128i x)
+    {
+        return _mm_cmpeq_epi32(_mm_and_si128(x, _mm_set1_epi32(1)), _mm_setzero_si128());
+    }
+    __attribute__((target("avx2"))) static __m128i check_jm(__m128i dj, __m128i dm)
+    {
+        return _mm_and_si128(even(_mm_xor_si128(dj, dm)), le(_mm_abs_epi32(dm), dj));
+    }
+    // 32 bit lane masks to 64 bit lane masks
+    __attribute__((target("avx2"))) static __m256d widen(__m128i mask)
+    {
+        return _mm256_castsi256_pd(_mm256_cvtepi32_epi64(mask));
+    }
+    // `(-1)^x`
+    __attribute__((target("avx2"))) static __m256d phase(__m128i x)
+    {
+        const __m128i one = _mm_set1_epi32(1);
+        return _mm256_cvtepi32_pd(_mm_sub_epi32(one, _mm_slli_epi32(_mm_and_si128(x, one), 1)));
+    }
+    __attribute__((target("avx2"))) static int hmax(__m128i x)
+    {
+        x = _mm_max_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+        x = _mm_max_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(x);
+    }
+    __attribute__((target("avx2"))) static int hmin(__m128i x)
+    {
+        x = _mm_min_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+        x = _mm_min_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(x);
+    }
+    // `binomial(n, k)` from the rows of a `BinomialTable<double>`, only the lanes with the sign bit of `mask` set are
+    // loaded, the others are 0
+    __attribute__((target("avx2"))) static __m256d binomial(const double *const *rows, __m128i n, __m128i k,
+                                                            __m256d mask)
+    {
+        k = _mm_min_epi32(k, _mm_sub_epi32(n, k));
+        __m256i p = _mm256_i32gather_epi64(reinterpret_cast<const long long *>(rows), n, 8);
+        p = _mm256_add_epi64(p, _mm256_slli_epi64(_mm256_cvtepi32_epi64(k), 3));
+        return _mm256_mask_i64gather_pd(_mm256_setzero_pd(), static_cast<const double *>(nullptr), p, mask, 1);
+    }
+};
+#endif
+
+// what a symbol does when its arguments need binomials beyond `nmax()`
+enum class ReserveMode
+{
+    unchecked, // no check, the caller must reserve enough (default)
+    grow,      // reserve the table on the fly
+    error,     // print an error and exit
+};
+
+// `Binomial` is the engine that provides `binomial(n, k)`, it should be `BinomialTable<T>` or `FactorialTable<T>`
+template <typename T, typename Binomial = BinomialTable<T>>
+class BasicWignerSymbols
+{
+  public:
+    using value_type = T;
+    using binomial_type = Binomial;
+    using result_type = typename _wigner_result<T>::type;
+
+    BasicWignerSymbols() = default;
+    // the binomial engine is constructed with `policy`, see `TablePolicy`
+    explicit BasicWignerSymbols(TablePolicy policy) : _binomial(policy), _triangle(policy), _CG0_table(policy) {}
+    BasicWignerSymbols(const BasicWignerSymbols &other)
+        : _binomial(other._binomial), _triangle(other._triangle), _CG0_table(other._CG0_table),
+          _reserve_mode(other.reserve_mode()), _closed_forms(other.closed_forms())
+    {
+    }
+
+    // the largest `n` of the stored binomial table
+    int nmax() const { return _binomial.nmax(); }
+    const Binomial &binomial_engine() const { return _binomial; }
+    const TriangleTable &triangle_table() const { return _triangle; }
+    // filled by `reserve(jmax, "CG0", 0)`, then `CG0` and `CG0_range` with `j1, j2 <= jmax` are lookups
+    const CG0Table<result_type> &CG0_table() const { return _CG0_table; }
+
+    // Each symbol computes the largest binomial `n` it needs once at the entry, the loops are not checked. In the
+    // `unchecked` mode this costs one comparison per call.
+    void set_reserve_mode(ReserveMode mode) { _reserve_mode.store(mode, std::memory_order_relaxed); }
+    ReserveMode reserve_mode() const { return _reserve_mode.load(std::memory_order_relaxed); }
+    // `f6j` with an argument `j <= 1` and `f9j` with a 0 or a line `(1/2, 1/2, S)` use the closed forms of
+    // `_f6j_small` and `_f9j_reduced` (default), `false` always sums the general formulas.
+    void set_closed_forms(bool on) { _closed_forms.store(on, std::memory_order_relaxed); }
+    bool closed_forms() const { return _closed_forms.load(std::memory_order_relaxed); }
+
+    // judge if a number is a odd number
+    static bool isodd(int x) { return x % 2 != 0; }
+    // judge if a number is a even number
+    static bool iseven(int x) { return x % 2 == 0; }
+    // judge if two number are same odd or same even
+    static bool is_same_parity(int x, int y) { return iseven(x ^ y); }
+    // return (-1)^n
+    static int iphase(int x) { return iseven(x) - isodd(x); }
+    // check if m-quantum number if one of the components of a the j-quantum number
+    static bool check_jm(int dj, int dm) { return is_same_parity(dj, dm) && (std::abs(dm) <= dj); }
+    // judge if three angular momentum can couple
+    static bool check_couple(int dj1, int dj2, int dj3)
+    {
+        return dj1 >= 0 && dj2 >= 0 && is_same_parity(dj1 + dj2, dj3) && (dj3 <= (dj1 + dj2)) &&
+               (dj3 >= std::abs(dj1 - dj2));
+    }
+    // Same as `check_couple`, but one branch free bitmap lookup for `dj <= triangle_table().djmax()`, which is
+    // filled by `reserve(djmax, "triad", 0)`. For loops over many triads, hoist `triangle_table().snapshot()`.
+    bool triad(int dj1, int dj2, int dj3) const { return _triangle(dj1, dj2, dj3); }
+    static bool check_couple_int(int j1, int j2, int j3)
+    {
+        return j1 >= 0 && j2 >= 0 && (j3 <= (j1 + j2)) && (j3 >= std::abs(j1 - j2));
+    }
+    // only works for positive n
+    static T quick_pow(T x, int n)
+    {
+        T ans = 1;
+        while (n)
+        {
+            if (n & 1)
+                ans = ans * x;
+            n = n >> 1;
+            x = x * x;
+        }
+        return ans;
+    }
+
+    T binomial(int n, int k) const
+    {
+        if (unsigned(n) > unsigned(nmax()) || unsigned(k) > unsigned(n))
+            return 0;
+        else
+            return unsafe_binomial(n, k);
+    }
+
+    T unsafe_binomial(int n, int k) const { return _binomial(n, k); }
+
+    result_type CG(int dj1, int dj2, int dj3, int dm1, int dm2, int dm3) const
+    {
+        if (!(check_jm(dj1, dm1) && check_jm(dj2, dm2) && check_jm(dj3, dm3)))
+            return 0;
+        if (!check_couple(dj1, dj2, dj3))
+            return 0;
+        if (dm1 + dm2 != dm3)
+            return 0;
+        const int J = (dj1 + dj2 + dj3) / 2;
+        _check_nmax(J + 1);
+        const auto &bin = _local_binomial();
+        const int jm1 = J - dj1;
+        const int jm2 = J - dj2;
+        const int jm3 = J - dj3;
+        const int j1mm1 = (dj1 - dm1) / 2;
+        const int j2mm2 = (dj2 - dm2) / 2;
+        const int j3mm3 = (dj3 - dm3) / 2;
+        const int j2pm2 = (dj2 + dm2) / 2;
+        T A;
+        if constexpr (_has_sqrt_binomial<Binomial>::value)
+            A = _sqrt_binomial(dj1, jm2) * _sqrt_binomial(dj2, jm3) * _inv_sqrt_binomial(J + 1, jm3) *
+                _inv_sqrt_binomial(dj1, j1mm1) * _inv_sqrt_binomial(dj2, j2mm2) * _inv_sqrt_binomial(dj3, j3mm3);
+        else
+            A = _sqrt(bin(dj1, jm2) * bin(dj2, jm3) /
+                      (bin(J + 1, jm3) * bin(dj1, j1mm1) * bin(dj2, j2mm2) * bin(dj3, j3mm3)));
+        const int low = std::max(0, std::max(j1mm1 - jm2, j2pm2 - jm1));
+        const int high = std::min(jm3, std::min(j1mm1, j2pm2));
+        const T B = _sum3(bin, jm3, jm2, j1mm1, jm1, j2pm2, low, high);
+        return static_cast<result_type>(iphase(high) * A * B);
+    }
+
+    result_type CG0(int j1, int j2, int j3) const
+    {
+        if (!check_couple_int(j1, j2, j3))
+            return 0;
+        const int J = j1 + j2 + j3;
+        if (isodd(J))
+            return 0;
+        if (const result_type *row = _CG0_table.row(j1, j2))
+            return row[(j3 - std::abs(j1 - j2)) / 2];
+        _check_nmax(J + 1);
+        return _CG0(_local_binomial(), j1, j2, j3);
+    }
+
+    // `CG0(j1, j2, j3)` of all `j3`, `out[(j3 - |j1 - j2|) / 2]` for `j3 = |j1 - j2|, |j1 - j2| + 2, ..., j1 + j2`,
+    // returns the count `min(j1, j2) + 1`. Rows in `CG0_table()` are copied, it can also be read in place.
+    int CG0_range(int j1, int j2, result_type *out) const
+    {
+        if (j1 < 0 || j2 < 0)
+            return 0;
+        const int count = std::min(j1, j2) + 1;
+        if (const result_type *row = _CG0_table.row(j1, j2))
+        {
+            std::copy(row, row + count, out);
+            return count;
+        }
+        _check_nmax(2 * (j1 + j2) + 1);
+        const auto &bin = _local_binomial();
+        for (int k = 0; k < count; ++k)
+            out[k] = _CG0(bin, j1, j2, std::abs(j1 - j2) + 2 * k);
+        return count;
+    }
+
+    result_type f3j(int dj1, int dj2, int dj3, int dm1, int dm2, int dm3) const
+    {
+        if (!(check_jm(dj1, dm1) && check_jm(dj2, dm2) && check_jm(dj3, dm3)))
+            return 0;
+        if (!check_couple(dj1, dj2, dj3))
+            return 0;
+        if (dm1 + dm2 + dm3 != 0)
+            return 0;
+        const int J = (dj1 + dj2 + dj3) / 2;
+        _check_nmax(J + 1);
+        const auto &bin = _local_binomial();
+        const int jm1 = J - dj1;
+        const int jm2 = J - dj2;
+        const int jm3 = J - dj3;
+        const int j1mm1 = (dj1 - dm1) / 2;
+        const int j2mm2 = (dj2 - dm2) / 2;
+        const int j3mm3 = (dj3 - dm3) / 2;
+        const int j1pm1 = (dj1 + dm1) / 2;
+        T A;
+        if constexpr (_has_sqrt_binomial<Binomial>::value)
+            A = _sqrt_binomial(dj1, jm2) * _sqrt_binomial(dj2, jm1) * _inv_sqrt_binomial(J + 1, 1) *
+                _inv_sqrt_binomial(J, jm3) * _inv_sqrt_binomial(dj1, j1mm1) * _inv_sqrt_binomial(dj2, j2mm2) *
+                _inv_sqrt_binomial(dj3, j3mm3);
+        else
+            A = _sqrt(bin(dj1, jm2) * bin(dj2, jm1) /
+                      ((J + 1) * bin(J, jm3) * bin(dj1, j1mm1) * bin(dj2, j2mm2) * bin(dj3, j3mm3)));
+        const int low = std::max(0, std::max(j1pm1 - jm2, j2mm2 - jm1));
+        const int high = std::min(jm3, std::min(j1pm1, j2mm2));
+        const T B = _sum3(bin, jm3, jm2, j1pm1, jm1, j2mm2, low, high);
+        return static_cast<result_type>(iphase(dj1 + (dj3 + dm3) / 2 + high) * A * B);
+    }
+
+    // Batch versions, `out[i] = CG(dj1[i], dj2[i], dj3[i], dm1[i], dm2[i], dm3[i])` for `0 <= i < n`. With
+    // `BinomialTable<double>` on a CPU with AVX2, 4 symbols are computed at once, the checks are vector masks and
+    // the binomials are gathered, so there are no data dependent branches. The results equal the scalar ones.
+    void CG(std::size_t n, const int *dj1, const int *dj2, const int *dj3, const int *dm1, const int *dm2,
+            const int *dm3, result_type *out) const
+    {
+        _batch<false>(n, {dj1, dj2, dj3, dm1, dm2, dm3}, out);
+    }
+
+    void f3j(std::size_t n, const int *dj1, const int *dj2, const int *dj3, const int *dm1, const int *dm2,
+             const int *dm3, result_type *out) const
+    {
+        _batch<true>(n, {dj1, dj2, dj3, dm1, dm2, dm3}, out);
+    }
+
+    // All the CG coefficients `<j1,m1;j2,m2|j3,m1+m2>` of one triad, the `(dj1 + 1) * (dj2 + 1)` pairs of `m1, m2` in
+    // `out[(dj1 + dm1) / 2 * (dj2 + 1) + (dj2 + dm2) / 2]`, entries with `|m1 + m2| > j3` are 0. It needs no binomial
+    // table. Each row `m1 + m2 = M >= 0` solves the three term recursion in `m1` from `J^2`, forward from the lower
+    // end and backward from the upper end to their largest values, where the two are matched, then it is normalized
+    // with `sum_m1 CG^2 = 1` and the upper end `m1 = j1` or `m2 = -j2` being positive. The rows `M < 0` follow from the
+    // symmetry `m -> -m`. So each entry costs O(1) and the recursions stay stable.
+    void CG_block(int dj1, int dj2, int dj3, result_type *out) const
+    {
+        using R = result_type;
+        if (dj1 < 0 || dj2 < 0)
+            return;
+        const int n2 = dj2 + 1;
+        std::fill(out, out + (dj1 + 1) * n2, R(0));
+        if (!check_couple(dj1, dj2, dj3))
+            return;
+        // `i1 = j1 + m1`, `i2 = j2 + m2`, a row has `i1 + i2 = sum` and `M = sum - (dj1 + dj2) / 2`
+        auto at = [out, n2](int sum, int i1) -> R & { return out[i1 * n2 + sum - i1]; };
+        const int top = (dj1 + dj2 + dj3) / 2;
+        const int d = dj3 * (dj3 + 2) - dj1 * (dj1 + 2) - dj2 * (dj2 + 2);
+        for (int sum = top; 2 * sum >= dj1 + dj2; --sum)
+        {
+            // `diag(i1) * x(i1) = q(i1 - 1) * x(i1 - 1) + q(i1) * x(i1 + 1)`, `q(low - 1) = q(high) = 0`
+            auto diag = [&](int i1) { return R(d - 2 * (2 * i1 - dj1) * (2 * (sum - i1) - dj2)) / 4; };
+            auto q = [&](int i1) {
+                const int i2 = sum - i1;
+                return _sqrt(R(i1 + 1) * R(dj1 - i1) * R(dj2 - i2 + 1) * R(i2));
+            };
+            const int low = std::max(0, sum - dj2), high = std::min(dj1, sum);
+            at(sum, low) = 1;
+            int mid = low;
+            if (high > low)
+            {
+                R q0 = q(low), q1;
+                at(sum, low + 1) = diag(low) / q0;
+                for (mid = low + 1; mid < high && _abs(at(sum, mid)) >= _abs(at(sum, mid - 1)); ++mid)
+                {
+                    q1 = q(mid);
+                    at(sum, mid + 1) = (diag(mid) * at(sum, mid) - q0 * at(sum, mid - 1)) / q1;
+                    q0 = q1;
+                    if (_abs(at(sum, mid + 1)) > _recursion_big<R>)
+                        for (int i1 = low; i1 <= mid + 1; ++i1)
+                            at(sum, i1) /= _recursion_big<R>;
+                }
+                // match the two solutions at `mid - 1` and `mid`
+                const R f0 = at(sum, mid - 1), f1 = at(sum, mid);
+                at(sum, high) = 1;
+                q0 = q(high - 1);
+                at(sum, high - 1) = diag(high) / q0;
+                for (int i1 = high - 1; i1 > mid - 1; --i1)
+                {
+                    q1 = q(i1 - 1);
+                    at(sum, i1 - 1) = (diag(i1) * at(sum, i1) - q0 * at(sum, i1 + 1)) / q1;
+                    q0 = q1;
+                    if (_abs(at(sum, i1 - 1)) > _recursion_big<R>)
+                        for (int i = i1 - 1; i <= high; ++i)
+                            at(sum, i) /= _recursion_big<R>;
+                }
+                const R b0 = at(sum, mid - 1), b1 = at(sum, mid);
+                const R scale = (f0 * b0 + f1 * b1) / (b0 * b0 + b1 * b1);
+                for (int i1 = low; i1 < mid - 1; ++i1)
+                    at(sum, i1) /= scale;
+            }
+            R largest = 0, norm = 0;
+            for (int i1 = low; i1 <= high; ++i1)
+                largest = std::max(largest, _abs(at(sum, i1)));
+            for (int i1 = low; i1 <= high; ++i1)
+                norm += (at(sum, i1) / largest) * (at(sum, i1) / largest);
+            const R factor = (at(sum, high) < 0 ? -1 : 1) / (largest * _sqrt(norm));
+            for (int i1 = low; i1 <= high; ++i1)
+                at(sum, i1) *= factor;
+        }
+        const R sign = iphase((dj1 + dj2 - dj3) / 2);
+        for (int sum = top - dj3; 2 * sum < dj1 + dj2; ++sum)
+        {
+            const int low = std::max(0, sum - dj2), high = std::min(dj1, sum);
+            for (int i1 = low; i1 <= high; ++i1)
+                at(sum, i1) = sign * at(dj1 + dj2 - sum, dj1 - i1);
+        }
+    }
+
+    // `f3j(dj1, dj2, dj3, dm1, dm2, dm3)` of all the allowed `dj3`, with `dm3 = -dm1 - dm2`, into
+    // `out[(dj3 - dj3min) / 2]` for `dj3min = max(|dj1 - dj2|, |dm3|) <= dj3 <= dj1 + dj2`, returns how many. It uses
+    // the Schulten-Gordon recursion in `j3`, `j3 A(j3+1) f(j3+1) + B(j3) f(j3) + (j3+1) A(j3) f(j3-1) = 0`, run forward
+    // and backward to the largest values like `CG_block`, normalized with `sum (2j3+1) f^2 = 1` and the sign of
+    // `f(j1+j2)` being `(-1)^(j1-j2-m3)`. Each symbol costs O(1) and it needs no binomial table.
+    int f3j_range(int dj1, int dj2, int dm1, int dm2, result_type *out) const
+    {
+        using R = result_type;
+        if (!(check_jm(dj1, dm1) && check_jm(dj2, dm2)))
+            return 0;
+        const int dm3 = -dm1 - dm2;
+        const int dj3min = std::max(std::abs(dj1 - dj2), std::abs(dm3));
+        const int count = (dj1 + dj2 - dj3min) / 2 + 1;
+        // in the doubled arguments, `a(dj) = 8 A(j)`, `b(dj) = 8 B(j)`, so `dj a f(+1) + 2 b f + (dj + 2) a f(-1) = 0`
+        const R s12 = R(dj1 - dj2) * R(dj1 - dj2), p12 = R(dj1 + dj2 + 2) * R(dj1 + dj2 + 2), s3 = R(dm3) * R(dm3);
+        const R c3 = R(dm3) * R(dj1 * (dj1 + 2) - dj2 * (dj2 + 2)), c12 = R(dm2 - dm1);
+        auto a = [&](int dj) {
+            const R d = R(dj) * R(dj);
+            return _sqrt((d - s12) * (p12 - d) * (d - s3));
+        };
+        auto b = [&](int dj) { return -R(dj + 1) * (c3 - R(dj) * R(dj + 2) * c12); };
+        // `f(k)` is `out[k]` of `dj = dj3min + 2 * k`
+        out[0] = 1;
+        int mid = 0;
+        if (count > 1)
+        {
+            // `a0 = a(dj)` and `a1 = a(dj + 2)` of the current `dj`
+            R a0 = 0, a1 = a(dj3min + 2);
+            if (dj3min == 0)
+                out[1] = R(dm1) / _sqrt(R(dj1) * R(dj1 + 2)); // `(j j 1; m -m 0) / (j j 0; m -m 0)`
+            else
+                out[1] = -b(dj3min) * 2 / (R(dj3min) * a1);
+            for (mid = 1; mid < count - 1 && _abs(out[mid]) >= _abs(out[mid - 1]); ++mid)
+            {
+                const int dj = dj3min + 2 * mid;
+                a0 = a1, a1 = a(dj + 2);
+                // the reciprocal does not depend on `out`, so the division is not in the dependency chain
+                const R inv = R(-1) / (R(dj) * a1);
+                out[mid + 1] = (b(dj) * 2 * out[mid] + R(dj + 2) * a0 * out[mid - 1]) * inv;
+                if (_abs(out[mid + 1]) > _recursion_big<R>)
+                    for (int k = 0; k <= mid + 1; ++k)
+                        out[k] /= _recursion_big<R>;
+            }
+            // match the two solutions at `mid - 1` and `mid`
+            const R f0 = out[mid - 1], f1 = out[mid];
+            const int djmax = dj1 + dj2;
+            a1 = 0, a0 = a(djmax);
+            out[count - 1] = 1;
+            out[count - 2] = -b(djmax) * 2 / (R(djmax + 2) * a0);
+            for (int k = count - 2; k > mid - 1; --k)
+            {
+                const int dj = dj3min + 2 * k;
+                a1 = a0, a0 = a(dj);
+                const R inv = R(-1) / (R(dj + 2) * a0);
+                out[k - 1] = (R(dj) * a1 * out[k + 1] + b(dj) * 2 * out[k]) * inv;
+                if (_abs(out[k - 1]) > _recursion_big<R>)
+                    for (int i = k - 1; i < count; ++i)
+                        out[i] /= _recursion_big<R>;
+            }
+            const R b0 = out[mid - 1], b1 = out[mid];
+            const R scale = (f0 * b0 + f1 * b1) / (b0 * b0 + b1 * b1);
+            for (int k = 0; k < mid - 1; ++k)
+                out[k] /= scale;
+        }
+        R largest = 0, norm = 0;
+        for (int k = 0; k < count; ++k)
+            largest = std::max(largest, _abs(out[k]));
+        for (int k = 0; k < count; ++k)
+            norm += R(dj3min + 2 * k + 1) * (out[k] / largest) * (out[k] / largest);
+        const R sign = iphase((dj1 - dj2 - dm3) / 2);
+        const R factor = (out[count - 1] * sign < 0 ? -1 : 1) / (largest * _sqrt(norm));
+        for (int k = 0; k < count; ++k)
+            out[k] *= factor;
+        return count;
+    }
+
+    // Gaunt coefficient `int Y_{l1 m1} Y_{l2 m2} Y_{l3 m3} dOmega` of the complex spherical harmonics, the arguments
+    // are not doubled. It is `sqrt((2l1+1)(2l2+1)(2l3+1)/(4pi)) (l1 l2 l3; 0 0 0) (l1 l2 l3; m1 m2 m3)`, the first 3j
+    // symbol is `(-1)^(l1-l2) CG0(l1, l2, l3) / sqrt(2l3+1)`, so the rows in `CG0_table()` are used if they are there.
+    result_type Gaunt(int l1, int l2, int l3, int m1, int m2, int m3) const
+    {
+        if (l1 < 0 || l2 < 0 || l3 < 0 || std::abs(m1) > l1 || std::abs(m2) > l2 || std::abs(m3) > l3)
+            return 0;
+        if (m1 + m2 + m3 != 0)
+            return 0;
+        const result_type x = CG0(l1, l2, l3);
+        if (x == 0)
+            return 0;
+        const result_type y = f3j(2 * l1, 2 * l2, 2 * l3, 2 * m1, 2 * m2, 2 * m3);
+        return iphase(l1 - l2) * x * y * _Gaunt_factor<T>(l1, l2);
+    }
+
+    result_type f6j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6) const
+    {
+        if (!(check_couple(dj1, dj2, dj3) && check_couple(dj1, dj5, dj6) && check_couple(dj4, dj2, dj6) &&
+              check_couple(dj4, dj5, dj3)))
+            return 0;
+        if (closed_forms())
+        {
+            // the smallest argument moves to `dj4` by the symmetries
+            const int dmin = std::min(std::min(std::min(dj1, dj2), std::min(dj3, dj4)), std::min(dj5, dj6));
+            if (dmin <= _small_6j)
+            {
+                if (dj4 == dmin)
+                    return _f6j_small(dj1, dj2, dj3, dj4, dj5, dj6);
+                if (dj5 == dmin)
+                    return _f6j_small(dj2, dj1, dj3, dj5, dj4, dj6);
+                if (dj6 == dmin)
+                    return _f6j_small(dj3, dj2, dj1, dj6, dj5, dj4);
+                if (dj1 == dmin)
+                    return _f6j_small(dj4, dj5, dj3, dj1, dj2, dj6);
+                if (dj2 == dmin)
+                    return _f6j_small(dj5, dj4, dj3, dj2, dj1, dj6);
+                return _f6j_small(dj6, dj5, dj1, dj3, dj2, dj4);
+            }
+        }
+        const int j123 = (dj1 + dj2 + dj3) / 2;
+        const int j156 = (dj1 + dj5 + dj6) / 2;
+        const int j426 = (dj4 + dj2 + dj6) / 2;
+        const int j453 = (dj4 + dj5 + dj3) / 2;
+        const int jpm123 = (dj1 + dj2 - dj3) / 2;
+        const int jpm132 = (dj1 + dj3 - dj2) / 2;
+        const int jpm231 = (dj2 + dj3 - dj1) / 2;
+        const int jpm156 = (dj1 + dj5 - dj6) / 2;
+        const int jpm426 = (dj4 + dj2 - dj6) / 2;
+        const int jpm453 = (dj4 + dj5 - dj3) / 2;
+        const int low = std::max(j123, std::max(j156, std::max(j426, j453)));
+        const int high = std::min(jpm123 + j453, std::min(jpm132 + j426, jpm231 + j156));
+        _check_nmax(std::max(low, high) + 1);
+        const auto &bin = _local_binomial();
+        // `A` includes the `1/(dj4 + 1)` factor
+        T A;
+        if constexpr (_has_sqrt_binomial<Binomial>::value)
+            A = _sqrt_binomial(j123 + 1, dj1 + 1) * _sqrt_binomial(dj1, jpm123) *
+                _inv_sqrt_binomial(j156 + 1, dj1 + 1) * _inv_sqrt_binomial(dj1, jpm156) *
+                _inv_sqrt_binomial(j453 + 1, dj4 + 1) * _inv_sqrt_binomial(dj4, jpm453) *
+                _inv_sqrt_binomial(j426 + 1, dj4 + 1) * _inv_sqrt_binomial(dj4, jpm426) *
+                _inv_sqrt_binomial(dj4 + 1, 1) * _inv_sqrt_binomial(dj4 + 1, 1);
+        else
+            A = _sqrt(bin(j123 + 1, dj1 + 1) * bin(dj1, jpm123) /
+                      (bin(j156 + 1, dj1 + 1) * bin(dj1, jpm156) * bin(j453 + 1, dj4 + 1) * bin(dj4, jpm453) *
+                       bin(j426 + 1, dj4 + 1) * bin(dj4, jpm426))) /
+                (dj4 + 1);
+        const T B = _sum6(bin, j123, jpm123, j453, jpm132, j426, jpm231, j156, low, high);
+        return static_cast<result_type>(iphase(high) * A * B);
+    }
+
+    // `f6j(dj1, dj2, dj3, dj4, dj5, dj6)` of all the allowed `dj1` into `out[(dj1 - dj1min) / 2]` for
+    // `dj1min = max(|dj2 - dj3|, |dj5 - dj6|) <= dj1 <= min(dj2 + dj3, dj5 + dj6)`, returns how many, 0 if there is no
+    // allowed `dj1`. Like `f3j_range` it uses the Schulten-Gordon recursion in `j1`,
+    // `j1 E(j1+1) f(j1+1) + F(j1) f(j1) + (j1+1) E(j1) f(j1-1) = 0`, run forward and backward to the largest values,
+    // normalized with `sum (2j1+1)(2j4+1) f^2 = 1` and the sign of `f(min(j2+j3, j5+j6))` being `(-1)^(j2+j3+j5+j6)`.
+    // Each symbol costs O(1) and it needs no binomial table. The other arguments move to `dj1` by the symmetries,
+    // for example the `dj3` of `{j1 j2 j3; j4 j5 j6}` are `f6j_range(dj1, dj2, dj6, dj4, dj5, out)`.
+    int f6j_range(int dj2, int dj3, int dj4, int dj5, int dj6, result_type *out) const
+    {
+        using R = result_type;
+        if (!(check_couple(dj4, dj2, dj6) && check_couple(dj4, dj5, dj3)) || ((dj2 + dj3 + dj5 + dj6) & 1))
+            return 0;
+        const int dj1min = std::max(std::abs(dj2 - dj3), std::abs(dj5 - dj6));
+        const int dj1max = std::min(dj2 + dj3, dj5 + dj6);
+        if (dj1min > dj1max)
+            return 0;
+        const int count = (dj1max - dj1min) / 2 + 1;
+        // in the doubled arguments, `e(dj) = 16 E(j)`, `g(dj) = 32 F(j) / (2dj + 2)` with `q = dj (dj + 2) = 4j(j+1)`,
+        // so `dj e(dj + 2) f(+1) + 2 (dj + 1) g f + (dj + 2) e(dj) f(-1) = 0`
+        const R s23 = R(dj2 - dj3) * R(dj2 - dj3), p23 = R(dj2 + dj3 + 2) * R(dj2 + dj3 + 2);
+        const R s56 = R(dj5 - dj6) * R(dj5 - dj6), p56 = R(dj5 + dj6 + 2) * R(dj5 + dj6 + 2);
+        const R q2 = R(dj2) * R(dj2 + 2), q3 = R(dj3) * R(dj3 + 2), q4 = R(dj4) * R(dj4 + 2);
+        const R q5 = R(dj5) * R(dj5 + 2), q6 = R(dj6) * R(dj6 + 2);
+        auto e = [&](int dj) {
+            const R d = R(dj) * R(dj);
+            return _sqrt((d - s23) * (p23 - d) * (d - s56) * (p56 - d));
+        };
+        auto g = [&](int dj) {
+            const R q1 = R(dj) * R(dj + 2);
+            return R(dj + 1) * (q1 * (q2 + q3 - q1 - 2 * q4) + q5 * (q1 + q2 - q3) + q6 * (q1 - q2 + q3));
+        };
+        // `f(k)` is `out[k]` of `dj = dj1min + 2 * k`
+        out[0] = 1;
+        int mid = 0;
+        if (count > 1)
+        {
+            // `e0 = e(dj)` and `e1 = e(dj + 2)` of the current `dj`
+            R e0 = 0, e1 = e(dj1min + 2);
+            if (dj1min == 0)
+                out[1] = -(q2 + q5 - q4) / (2 * _sqrt(q2 * q5)); // `{1 j2 j2; j4 j5 j5} / {0 j2 j2; j4 j5 j5}`
+            else
+                out[1] = -g(dj1min) * 2 / (R(dj1min) * e1);
+            for (mid = 1; mid < count - 1 && _abs(out[mid]) >= _abs(out[mid - 1]); ++mid)
+            {
+                const int dj = dj1min + 2 * mid;
+                e0 = e1, e1 = e(dj + 2);
+                const R inv = R(-1) / (R(dj) * e1);
+                out[mid + 1] = (g(dj) * 2 * out[mid] + R(dj + 2) * e0 * out[mid - 1]) * inv;
+                if (_abs(out[mid + 1]) > _recursion_big<R>)
+                    for (int k = 0; k <= mid + 1; ++k)
+                        out[k] /= _recursion_big<R>;
+            }
+            // match the two solutions at `mid - 1` and `mid`
+            const R f0 = out[mid - 1], f1 = out[mid];
+            e1 = 0, e0 = e(dj1max);
+            out[count - 1] = 1;
+            out[count - 2] = -g(dj1max) * 2 / (R(dj1max + 2) * e0);
+            for (int k = count - 2; k > mid - 1; --k)
+            {
+                const int dj = dj1min + 2 * k;
+                e1 = e0, e0 = e(dj);
+                const R inv = R(-1) / (R(dj + 2) * e0);
+                out[k - 1] = (R(dj) * e1 * out[k + 1] + g(dj) * 2 * out[k]) * inv;
+                if (_abs(out[k - 1]) > _recursion_big<R>)
+                    for (int i = k - 1; i < count; ++i)
+                        out[i] /= _recursion_big<R>;
+            }
+            const R b0 = out[mid - 1], b1 = out[mid];
+            const R scale = (f0 * b0 + f1 * b1) / (b0 * b0 + b1 * b1);
+            for (int k = 0; k < mid - 1; ++k)
+                out[k] /= scale;
+        }
+        R largest = 0, norm = 0;
+        for (int k = 0; k < count; ++k)
+            largest = std::max(largest, _abs(out[k]));
+        for (int k = 0; k < count; ++k)
+            norm += R(dj1min + 2 * k + 1) * (out[k] / largest) * (out[k] / largest);
+        const R sign = iphase((dj2 + dj3 + dj5 + dj6) / 2);
+        const R factor = (out[count - 1] * sign < 0 ? -1 : 1) / (largest * _sqrt(norm * R(dj4 + 1)));
+        for (int k = 0; k < count; ++k)
+            out[k] *= factor;
+        return count;
+    }
+
+    result_type Racah(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6) const
+    {
+        return iphase((dj1 + dj2 + dj3 + dj4) / 2) * f6j(dj1, dj2, dj5, dj4, dj3, dj6);
+    }
+
+    result_type f9j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6, int dj7, int dj8, int dj9) const
+    {
+        if (!(check_couple(dj1, dj2, dj3) && check_couple(dj4, dj5, dj6) && check_couple(dj7, dj8, dj9) &&
+              check_couple(dj1, dj4, dj7) && check_couple(dj2, dj5, dj8) && check_couple(dj3, dj6, dj9)))
+            return 0;
+        if (closed_forms())
+        {
+            int d[9] = {dj1, dj2, dj3, dj4, dj5, dj6, dj7, dj8, dj9};
+            result_type x;
+            if (_f9j_reduced(d, x))
+                return x;
+        }
+        const int j123 = (dj1 + dj2 + dj3) / 2;
+        const int j456 = (dj4 + dj5 + dj6) / 2;
+        const int j789 = (dj7 + dj8 + dj9) / 2;
+        const int j147 = (dj1 + dj4 + dj7) / 2;
+        const int j258 = (dj2 + dj5 + dj8) / 2;
+        const int j369 = (dj3 + dj6 + dj9) / 2;
+        const int pm123 = (dj1 + dj2 - dj3) / 2;
+        const int pm132 = (dj1 + dj3 - dj2) / 2;
+        const int pm231 = (dj2 + dj3 - dj1) / 2;
+        const int pm456 = (dj4 + dj5 - dj6) / 2;
+        const int pm465 = (dj4 + dj6 - dj5) / 2;
+        const int pm564 = (dj5 + dj6 - dj4) / 2;
+        const int pm789 = (dj7 + dj8 - dj9) / 2;
+        const int pm798 = (dj7 + dj9 - dj8) / 2;
+        const int pm897 = (dj8 + dj9 - dj7) / 2;
+        const int dtl = std::max(std::abs(dj2 - dj6), std::max(std::abs(dj4 - dj8), std::abs(dj1 - dj9)));
+        const int dth = std::min(dj2 + dj6, std::min(dj4 + dj8, dj1 + dj9));
+        {
+            // the loop bounds grow with `dt`, so the largest `n` is reached at `dth`
+            const int j19t = (dj1 + dj9 + dth) / 2;
+            const int j26t = (dj2 + dj6 + dth) / 2;
+            const int j48t = (dj4 + dj8 + dth) / 2;
+            const int xh = std::min(pm123 + j369, std::min(pm132 + j26t, pm231 + j19t));
+            const int yh = std::min(pm456 + j26t, std::min(pm465 + j258, pm564 + j48t));
+            const int zh = std::min(pm789 + j19t, std::min(pm798 + j48t, pm897 + j147));
+            const int jmax = std::max(std::max(std::max(j123, j456), std::max(j789, j147)), std::max(j258, j369));
+            const int tmax = std::max(std::max(j19t, j26t), std::max(j48t, std::max(xh, std::max(yh, zh))));
+            _check_nmax(std::max(jmax, tmax) + 1);
+        }
+        const auto &bin = _local_binomial();
+        T P0;
+        if constexpr (_has_sqrt_binomial<Binomial>::value)
+        {
+            P0 = _sqrt_binomial(j123 + 1, dj1 + 1) * _sqrt_binomial(dj1, pm123) * //
+                 _sqrt_binomial(j456 + 1, dj5 + 1) * _sqrt_binomial(dj5, pm456) * //
+                 _sqrt_binomial(j789 + 1, dj9 + 1) * _sqrt_binomial(dj9, pm798);
+            P0 *= _inv_sqrt_binomial(j147 + 1, dj1 + 1) * _inv_sqrt_binomial(dj1, (dj1 + dj4 - dj7) / 2) *
+                  _inv_sqrt_binomial(j258 + 1, dj5 + 1) * _inv_sqrt_binomial(dj5, (dj2 + dj5 - dj8) / 2) *
+                  _inv_sqrt_binomial(j369 + 1, dj9 + 1) * _inv_sqrt_binomial(dj9, (dj3 + dj9 - dj6) / 2);
+        }
+        else
+        {
+            const T P0_nu = bin(j123 + 1, dj1 + 1) * bin(dj1, pm123) * //
+                            bin(j456 + 1, dj5 + 1) * bin(dj5, pm456) * //
+                            bin(j789 + 1, dj9 + 1) * bin(dj9, pm798);
+            const T P0_de = bin(j147 + 1, dj1 + 1) * bin(dj1, (dj1 + dj4 - dj7) / 2) * bin(j258 + 1, dj5 + 1) *
+                            bin(dj5, (dj2 + dj5 - dj8) / 2) * bin(j369 + 1, dj9 + 1) * bin(dj9, (dj3 + dj9 - dj6) / 2);
+            P0 = _sqrt(P0_nu / P0_de);
+        }
+        T PABC = 0;
+        for (auto dt = dtl; dt <= dth; dt += 2)
+        {
+            const int j19t = (dj1 + dj9 + dt) / 2;
+            const int j26t = (dj2 + dj6 + dt) / 2;
+            const int j48t = (dj4 + dj8 + dt) / 2;
+            T Pt_de = bin(j19t + 1, dt + 1) * bin(dt, (dj1 + dt - dj9) / 2) * bin(j26t + 1, dt + 1) *
+                      bin(dt, (dj2 + dt - dj6) / 2) * bin(j48t + 1, dt + 1) * bin(dt, (dj4 + dt - dj8) / 2);
+            Pt_de *= (dt + 1) * (dt + 1);
+            const int xl = std::max(j123, std::max(j369, std::max(j26t, j19t)));
+            const int xh = std::min(pm123 + j369, std::min(pm132 + j26t, pm231 + j19t));
+            const T At = _sum6(bin, j123, pm123, j369, pm132, j26t, pm231, j19t, xl, xh);
+            const int yl = std::max(j456, std::max(j26t, std::max(j258, j48t)));
+            const int yh = std::min(pm456 + j26t, std::min(pm465 + j258, pm564 + j48t));
+            const T Bt = _sum6(bin, j456, pm456, j26t, pm465, j258, pm564, j48t, yl, yh);
+            const int zl = std::max(j789, std::max(j19t, std::max(j48t, j147)));
+            const int zh = std::min(pm789 + j19t, std::min(pm798 + j48t, pm897 + j147));
+            const T Ct = _sum6(bin, j789, pm789, j19t, pm798, j48t, pm897, j147, zl, zh);
+            PABC += iphase(xh + yh + zh) * At * Bt * Ct / Pt_de;
+        }
+        return static_cast<result_type>(iphase(dth) * P0 * PABC);
+    }
+
+    result_type norm9j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6, int dj7, int dj8, int dj9)
+    {
+        return f9j(dj1, dj2, dj3, dj4, dj5, dj6, dj7, dj8, dj9) *
+               std::sqrt((dj3 + 1.) * (dj6 + 1.) * (dj7 + 1.) * (dj8 + 1.));
+    }
+
+    static double lsjj(int l1, int l2, int dj1, int dj2, int L, int S, int J)
+    {
+        if (!check_couple(2 * l1, 2 * l2, 2 * L))
+            return 0.0;
+        if (!check_couple(dj1, dj2, 2 * J))
+            return 0.0;
+
+        int LSJcase = 0;
+        if (S == 0)
+        {
+            LSJcase = 1;
+        }
+        else if (S == 1)
+        {
+            if (L == J - 1)
+                LSJcase = 2;
+            else if (J == L)
+                LSJcase = 3;
+            else if (L == J + 1)
+                LSJcase = 4;
+        }
+        if (LSJcase == 0)
+            return 0.0;
+
+        const int m = l1 - l2;
+        const int p = l1 + l2;
+        const int d1 = dj1 - 2 * l1;
+        const int d2 = dj2 - 2 * l2;
+        const double den = 2 * (2 * l1 + 1) * (2 * l2 + 1);
+        double r = 0.0;
+
+        if (d1 == 1 && d2 == 1)
+        {
+            if (LSJcase == 1)
+            {
+                r = (J + p + 2) * (p + 1 - J) / den;
+            }
+            else if (LSJcase == 2)
+            {
+                r = (J + m) * (J - m) / static_cast<double>(J * (2 * J + 1));
+                r *= (J + p + 1) * (J + p + 2) / den;
+            }
+            else if (LSJcase == 3)
+            {
+                if (m == 0)
+                    return 0.0;
                 r = m * std::abs(m) / static_cast<double>(J * (J + 1));
                 r *= (J + p + 2) * (p + 1 - J) / den;
             }
@@ -351,342 +1718,1675 @@ class WignerSymbols
                 r *= (p - J) * (p + 1 - J) / den;
             }
         }
-        else if (d1 == 1 && d2 == -1)
+        else if (d1 == 1 && d2 == -1)
+        {
+            if (LSJcase == 1)
+            {
+                r = (J + m + 1) * (J - m) / den;
+            }
+            else if (LSJcase == 2)
+            {
+                r = -(p + 1 + J) * (p + 1 - J) / static_cast<double>(J * (2 * J + 1));
+                r *= (J + m + 1) * (J + m) / den;
+            }
+            else if (LSJcase == 3)
+            {
+                r = (p + 1) * (p + 1) / static_cast<double>(J * (J + 1));
+                r *= (J + m + 1) * (J - m) / den;
+            }
+            else if (LSJcase == 4)
+            {
+                r = -(p + 1 + L) * (p + 1 - L) / static_cast<double>(L * (2 * J + 1));
+                r *= (J - m + 1) * (J - m) / den;
+            }
+        }
+        else if (d1 == -1 && d2 == 1)
+        {
+            if (LSJcase == 1)
+            {
+                r = -(J + m) * (J - m + 1) / den;
+            }
+            else if (LSJcase == 2)
+            {
+                r = (p + 1 + J) * (p + 1 - J) / static_cast<double>(J * (2 * J + 1));
+                r *= (J - m) * (J - m + 1) / den;
+            }
+            else if (LSJcase == 3)
+            {
+                r = (p + 1) * (p + 1) / static_cast<double>(J * (J + 1));
+                r *= (J + m) * (J - m + 1) / den;
+            }
+            else if (LSJcase == 4)
+            {
+                r = (p + 1 + L) * (p + 1 - L) / static_cast<double>(L * (2 * J + 1));
+                r *= (J + m + 1) * (J + m) / den;
+            }
+        }
+        else if (d1 == -1 && d2 == -1)
+        {
+            if (LSJcase == 1)
+            {
+                r = (J + p + 1) * (p - J) / den;
+            }
+            else if (LSJcase == 2)
+            {
+                r = -(J + m) * (J - m) / static_cast<double>(J * (2 * J + 1));
+                r *= (p - J) * (p + 1 - J) / den;
+            }
+            else if (LSJcase == 3)
+            {
+                if (m == 0)
+                    return 0.0;
+                r = -m * std::abs(m) / static_cast<double>(J * (J + 1));
+                r *= (J + p + 1) * (p - J) / den;
+            }
+            else if (LSJcase == 4)
+            {
+                r = (L + m) * (L - m) / static_cast<double>(L * (2 * J + 1));
+                r *= (J + p + 1) * (J + p + 2) / den;
+            }
+        }
+
+        return std::copysign(std::sqrt(std::abs(r)), r);
+    }
+
+    template <typename Lookup>
+    T _m9j(const Lookup &bin, int j1, int j2, int j3, int j4, int j5, int j6, int j7, int j8, int j9) const
+    {
+        const int j123 = j1 + j2 + j3;
+        const int j456 = j4 + j5 + j6;
+        const int j789 = j7 + j8 + j9;
+        const int j147 = j1 + j4 + j7;
+        const int j258 = j2 + j5 + j8;
+        const int j369 = j3 + j6 + j9;
+        const int pm123 = j1 + j2 - j3;
+        const int pm132 = j1 + j3 - j2;
+        const int pm231 = j2 + j3 - j1;
+        const int pm456 = j4 + j5 - j6;
+        const int pm465 = j4 + j6 - j5;
+        const int pm564 = j5 + j6 - j4;
+        const int pm789 = j7 + j8 - j9;
+        const int pm798 = j7 + j9 - j8;
+        const int pm897 = j8 + j9 - j7;
+        T sum = 0.0;
+        const int tl = std::max(std::abs(j2 - j6), std::max(std::abs(j4 - j8), std::abs(j1 - j9)));
+        const int th = std::min(j2 + j6, std::min(j4 + j8, j1 + j9));
+        for (int t = tl; t <= th; ++t)
+        {
+            const int j19t = j1 + j9 + t;
+            const int j26t = j2 + j6 + t;
+            const int j48t = j4 + j8 + t;
+            const int dt = 2 * t;
+            T Pt_de = bin(j19t + 1, dt + 1) * bin(dt, j1 + t - j9) * bin(j26t + 1, dt + 1) * bin(dt, j2 + t - j6) *
+                      bin(j48t + 1, dt + 1) * bin(dt, j4 + t - j8);
+            Pt_de *= (dt + 1) * (dt + 1);
+            const int xl = std::max(j123, std::max(j369, std::max(j26t, j19t)));
+            const int xh = std::min(pm123 + j369, std::min(pm132 + j26t, pm231 + j19t));
+            const T At = _sum6(bin, j123, pm123, j369, pm132, j26t, pm231, j19t, xl, xh);
+            const int yl = std::max(j456, std::max(j26t, std::max(j258, j48t)));
+            const int yh = std::min(pm456 + j26t, std::min(pm465 + j258, pm564 + j48t));
+            const T Bt = _sum6(bin, j456, pm456, j26t, pm465, j258, pm564, j48t, yl, yh);
+            const int zl = std::max(j789, std::max(j19t, std::max(j48t, j147)));
+            const int zh = std::min(pm789 + j19t, std::min(pm798 + j48t, pm897 + j147));
+            const T Ct = _sum6(bin, j789, pm789, j19t, pm798, j48t, pm897, j147, zl, zh);
+            sum += iphase(xh + yh + zh) * At * Bt * Ct / Pt_de;
+        }
+        return sum;
+    }
+
+    // Buck et al. Nuc. Phys. A 600 (1996) 387-402
+    result_type Moshinsky(int N, int L, int n, int l, int n1, int l1, int n2, int l2, int lambda,
+                          double tan_beta = 1.0) const
+    {
+        if (!check_couple_int(L, l, lambda) || !check_couple_int(l1, l2, lambda))
+            return 0.0;
+        // check energy conservation
+        const int e1 = 2 * n1 + l1;
+        const int e2 = 2 * n2 + l2;
+        const int E = 2 * N + L;
+        const int e = 2 * n + l;
+        if (e1 + e2 != e + E)
+            return 0;
+
+        const int nl1 = n1 + l1;
+        const int nl2 = n2 + l2;
+        const int NL = N + L;
+        const int nl = n + l;
+        const int chi = e1 + e2;
+        // the same estimate as `reserve(num, "Moshinsky", rank)`, `chi + 2` is larger only for `chi = 0`
+        _check_nmax(std::max(chi + 2, 3 * chi + 1));
+        const auto &bin = _local_binomial();
+
+        const double cos_beta = 1.0 / std::sqrt(1.0 + tan_beta * tan_beta);
+        const double sin_beta = tan_beta * cos_beta;
+        T pre;
+        if constexpr (_has_sqrt_binomial<Binomial>::value)
+        {
+            pre = _sqrt_binomial(chi + 2, e1 + 1) * _inv_sqrt_binomial(chi + 2, E + 1);
+            pre *= _sqrt_binomial(L + l + lambda + 1, 2 * lambda + 1) * _sqrt_binomial(2 * lambda, lambda + L - l);
+            pre *= _inv_sqrt_binomial(l1 + l2 + lambda + 1, 2 * lambda + 1) *
+                   _inv_sqrt_binomial(2 * lambda, lambda + l1 - l2);
+
+            pre *= _sqrt_binomial(2 * l1 + 1, 1) * _sqrt_binomial(2 * nl1 + 1, nl1) * _inv_sqrt_binomial(e1 + 1, n1);
+            pre *= _sqrt_binomial(2 * l2 + 1, 1) * _sqrt_binomial(2 * nl2 + 1, nl2) * _inv_sqrt_binomial(e2 + 1, n2);
+            pre *= _sqrt_binomial(2 * L + 1, 1) * _sqrt_binomial(2 * NL + 1, NL) * _inv_sqrt_binomial(E + 1, N);
+            pre *= _sqrt_binomial(2 * l + 1, 1) * _sqrt_binomial(2 * nl + 1, nl) * _inv_sqrt_binomial(e + 1, n);
+            // 2^(-(l1 + l2 + L + l)/2) / ((e1 + 2) * (e2 + 2))
+            pre *= quick_pow(_inv_sqrt_binomial(2, 1), l1 + l2 + L + l);
+            pre *= _inv_sqrt_binomial(e1 + 2, 1) * _inv_sqrt_binomial(e1 + 2, 1) * _inv_sqrt_binomial(e2 + 2, 1) *
+                   _inv_sqrt_binomial(e2 + 2, 1);
+        }
+        else
+        {
+            pre = bin(chi + 2, e1 + 1) / bin(chi + 2, E + 1);
+            pre *= bin(L + l + lambda + 1, 2 * lambda + 1) * bin(2 * lambda, lambda + L - l);
+            pre /= bin(l1 + l2 + lambda + 1, 2 * lambda + 1) * bin(2 * lambda, lambda + l1 - l2);
+
+            pre *= (2 * l1 + 1) * bin(2 * nl1 + 1, nl1) / (bin(e1 + 1, n1) * quick_pow(2.0, l1));
+            pre *= (2 * l2 + 1) * bin(2 * nl2 + 1, nl2) / (bin(e2 + 1, n2) * quick_pow(2.0, l2));
+            pre *= (2 * L + 1) * bin(2 * NL + 1, NL) / (bin(E + 1, N) * quick_pow(2.0, L));
+            pre *= (2 * l + 1) * bin(2 * nl + 1, nl) / (bin(e + 1, n) * quick_pow(2.0, l));
+            pre = _sqrt(pre) / ((e1 + 2) * (e2 + 2));
+        }
+
+        T sum = 0.0;
+        for (int ea = 0; ea <= std::min(e1, E); ++ea)
+        {
+            const int eb = e1 - ea;
+            const int ec = E - ea;
+            const int ed = e2 - ec;
+            if (ed < 0)
+                continue;
+            const T tfa = quick_pow(sin_beta, ea + ed) * quick_pow(cos_beta, eb + ec) * bin(e1 + 2, ea + 1) *
+                          bin(e2 + 2, ec + 1);
+            for (int la = ea & 0x01; la <= ea; la += 2)
+            {
+                const int na = (ea - la) / 2;
+                const int nla = na + la;
+                const T _ta = quick_pow(2, la) * (2 * la + 1) * bin(ea + 1, na) / bin(2 * nla + 1, nla);
+                const T ta = tfa * _ta;
+                for (int lb = std::abs(l1 - la); lb <= std::min(l1 + la, eb); lb += 2)
+                {
+                    const int nb = (eb - lb) / 2;
+                    const int nlb = nb + lb;
+                    const T _tb = quick_pow(2, lb) * (2 * lb + 1) * bin(eb + 1, nb) / bin(2 * nlb + 1, nlb);
+                    const int g1 = (la + lb + l1) / 2;
+                    const T t1 = bin(g1, l1) * bin(l1, g1 - la);
+                    const T tb = ta * _tb * t1;
+                    for (int lc = std::abs(L - la); lc <= std::min(L + la, ec); lc += 2)
+                    {
+                        const int nc = (ec - lc) / 2;
+                        const int nlc = nc + lc;
+                        const T _tc = quick_pow(2, lc) * (2 * lc + 1) * bin(ec + 1, nc) / bin(2 * nlc + 1, nlc);
+                        const int g3 = (la + lc + L) / 2;
+                        const T t3 = bin(g3, L) * bin(L, g3 - la);
+                        const T d3 = (2 * L + 1) * bin(la + lc + L + 1, 2 * L + 1) * bin(2 * L, L + la - lc);
+                        const T tc = tb * _tc * t3 / d3;
+                        const int ldmin = std::max(std::abs(l2 - lc), std::abs(l - lb));
+                        const int ldmax = std::min(ed, std::min(l2 + lc, l + lb));
+                        for (int ld = ldmin; ld <= ldmax; ld += 2)
+                        {
+                            const int nd = (ed - ld) / 2;
+                            const int nld = nd + ld;
+                            const T _td = quick_pow(2, ld) * (2 * ld + 1) * bin(ed + 1, nd) / bin(2 * nld + 1, nld);
+                            const int g2 = (lc + ld + l2) / 2;
+                            const T t2 = bin(g2, l2) * bin(l2, g2 - lc);
+                            const int g4 = (lb + ld + l) / 2;
+                            const T t4 = bin(g4, l) * bin(l, g4 - lb);
+                            const T d4 = (2 * l + 1) * bin(lb + ld + l + 1, 2 * l + 1) * bin(2 * l, l + lb - ld);
+                            const T td = tc * _td * t2 * t4 / d4;
+                            const T m9j = _m9j(bin, la, lb, l1, lc, ld, l2, L, l, lambda);
+                            sum += iphase(ld) * td * m9j;
+                        }
+                    }
+                }
+            }
+        }
+        return static_cast<result_type>(pre * sum);
+    }
+
+    // The alternating sum of `d^j_{m1 m2}` cancels for large `j`, at `j = 60` and `beta = 1` it has lost all its
+    // digits. It only gives the lowest `j0 = max(|m1|, |m2|)` and `j0 + 1`, with at most two terms, and the three term
+    // recursion in `j` of the Jacobi polynomials, which is stable for all `beta`, goes up from them.
+    result_type dfunc(int dj, int dm1, int dm2, double beta) const
+    {
+        if (!(check_jm(dj, dm1) && check_jm(dj, dm2)))
+            return 0.;
+        const double c = std::cos(beta / 2);
+        const double s = std::sin(beta / 2);
+        const int dj0 = std::max(std::abs(dm1), std::abs(dm2));
+        if (dj - dj0 < 4)
+            return static_cast<result_type>(_dfunc_sum(dj, dm1, dm2, c, s));
+        using R = std::conditional_t<std::is_same<result_type, float>::value, double, result_type>;
+        const R x = std::cos(beta);
+        R d0 = static_cast<R>(_dfunc_sum(dj0, dm1, dm2, c, s));
+        R d1 = static_cast<R>(_dfunc_sum(dj0 + 2, dm1, dm2, c, s));
+        // `q(k) = sqrt((k^2 - dm1^2) (k^2 - dm2^2))` for the doubled `k = 2j`, each one is used by two steps
+        auto q = [&](int k) { return _sqrt(R(k * k - dm1 * dm1) * R(k * k - dm2 * dm2)); };
+        R q0 = q(dj0 + 2);
+        for (int k = dj0 + 2; k < dj; k += 2)
+        {
+            const R q1 = q(k + 2);
+            const R d2 = (2 * (k + 1) * (R(k) * (k + 2) * x - dm1 * dm2) * d1 - (k + 2) * q0 * d0) / (k * q1);
+            d0 = d1, d1 = d2, q0 = q1;
+        }
+        return static_cast<result_type>(d1);
+    }
+
+    void reserve(int num, std::string type, int rank)
+    {
+        if (type == "Jmax")
+        {
+            switch (rank)
+            {
+                case 3: _binomial.reserve(3 * num + 1); break;
+                case 6: _binomial.reserve(4 * num + 1); break;
+                case 9: _binomial.reserve(5 * num + 1); break;
+                default:
+                {
+                    std::cerr << "Error: rank must be 3, 6, or 9" << std::endl;
+                    std::exit(-1);
+                }
+            }
+        }
+        else if (type == "2bjmax")
+        {
+            switch (rank)
+            {
+                case 3: _binomial.reserve(2 * num + 1); break;
+                case 6: _binomial.reserve(3 * num + 1); break;
+                case 9: _binomial.reserve(4 * num + 1); break;
+                default:
+                {
+                    std::cerr << "Error: rank must be 3, 6, or 9" << std::endl;
+                    std::exit(-1);
+                }
+            }
+        }
+        else if (type == "Moshinsky")
+        {
+            _binomial.reserve(6 * num + 1);
+        }
+        else if (type == "nmax")
+        {
+            _binomial.reserve(num);
+        }
+        else if (type == "triad")
+        {
+            _triangle.reserve(num);
+        }
+        else if (type == "CG0")
+        {
+            _binomial.reserve(4 * num + 1);
+            _CG0_table.reserve(num, [this, &bin = _local_binomial()](int j1, int j2, result_type *row) {
+                for (int k = 0; k <= j2; ++k)
+                    row[k] = _CG0(bin, j1, j2, j1 - j2 + 2 * k);
+            });
+        }
+        else
+        {
+            std::cerr << "Error: type must be Jmax, 2bjmax, Moshinsky, nmax, triad or CG0" << std::endl;
+            std::exit(-1);
+        }
+    }
+
+  private:
+    // `sum_{x = low}^{high} (-1)^(high - x) term(x)`, the kernel of the alternating sums of `CG`, `f3j`, `f6j`, `f9j`
+    // and `dfunc`. Each term is computed on its own, generating them by their ratios was measured to be no faster for
+    // the binomial sums and 2 to 4 times less accurate, and the first term of `d^j` underflows for large `j`.
+    template <typename Term>
+    static T _alternating_sum(int low, int high, Term term)
+    {
+        T B = 0;
+        for (auto x = low; x <= high; ++x)
+            B = -B + term(x);
+        return B;
+    }
+
+    // `d^j_{m1 m2}` by its alternating sum, `c = cos(beta / 2)` and `s = sin(beta / 2)`
+    T _dfunc_sum(int dj, int dm1, int dm2, double c, double s) const
+    {
+        _check_nmax(dj);
+        const auto &bin = _local_binomial();
+        const int jm1 = (dj - dm1) / 2;
+        const int jp1 = (dj + dm1) / 2;
+        const int jm2 = (dj - dm2) / 2;
+        const int mm = (dm1 + dm2) / 2;
+        const int kmin = std::max(0, -mm);
+        const int kmax = std::min(jm1, jm2);
+        T sum = _alternating_sum(kmin, kmax, [&](int k) {
+            return bin(jm1, k) * bin(jp1, mm + k) * quick_pow(c, mm + 2 * k) * quick_pow(s, jm1 + jm2 - 2 * k);
+        });
+        sum = iphase(jm2 + kmax) * sum;
+        if constexpr (_has_sqrt_binomial<Binomial>::value)
+            return sum * _sqrt_binomial(dj, jm1) * _inv_sqrt_binomial(dj, jm2);
+        else
+            return sum * _sqrt(bin(dj, jm1) / bin(dj, jm2));
+    }
+
+    // `sum_z (-1)^(high - z) binomial(n1, z) binomial(n2, k2 - z) binomial(n3, k3 - z)` for `low <= z <= high`, the
+    // sum of `CG` and `f3j`
+    template <typename Lookup>
+    static T _sum3(const Lookup &bin, int n1, int n2, int k2, int n3, int k3, int low, int high)
+    {
+        return _alternating_sum(low, high, [&](int z) { return bin(n1, z) * bin(n2, k2 - z) * bin(n3, k3 - z); });
+    }
+
+    // `sum_x (-1)^(high - x) binomial(x + 1, a + 1) binomial(b1, x - c1) binomial(b2, x - c2) binomial(b3, x - c3)`
+    // for `low <= x <= high`, the sum of `f6j` and the three sums of `f9j` and `_m9j`
+    template <typename Lookup>
+    static T _sum6(const Lookup &bin, int a, int b1, int c1, int b2, int c2, int b3, int c3, int low, int high)
+    {
+        return _alternating_sum(low, high, [&](int x) {
+            return bin(x + 1, a + 1) * bin(b1, x - c1) * bin(b2, x - c2) * bin(b3, x - c3);
+        });
+    }
+
+    // the largest `dj4` of `_f6j_small`
+    static constexpr int _small_6j = 2;
+
+    // `f6j` with `j4 <= 1`, the closed forms of Edmonds' table 5, without the binomials, `float` is computed in
+    // `double`. The symmetries bring it to `{a b c; s e f}` with `y = e - c <= x = f - b` and `x + y <= 0`. If
+    // `y = -s`, the triad `(s e c)` is stretched and the Racah sum has one term,
+    // `(-1)^S sqrt(Q_s(m) / D)` for `S = a + b + c`, `m = x + s`,
+    // `Q_s(m) = C(2s, m) (S+1)...(S-2s+m+2) (S-2a)...(S-2a-2s+m+1) (S-2b)...(S-2b-m+1) (S-2c+1)...(S-2c+m)` and
+    // `D = (b+f-s+1)...(b+f+s+1) (c+e-s+1)...(c+e+s+1)`. Beyond `j4 = 1` the general sum is as fast.
+    result_type _f6j_small(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6) const
+    {
+        using R = std::conditional_t<std::is_same<result_type, float>::value, double, result_type>;
+        // swap the columns `b, c`, and the rows of the columns `b, c`
+        if (dj5 - dj3 > dj6 - dj2)
+            std::swap(dj2, dj3), std::swap(dj5, dj6);
+        if (dj5 - dj3 + dj6 - dj2 > 0)
+        {
+            std::swap(dj2, dj5), std::swap(dj3, dj6);
+            if (dj5 - dj3 > dj6 - dj2)
+                std::swap(dj2, dj3), std::swap(dj5, dj6);
+        }
+        const int S = (dj1 + dj2 + dj3) / 2, y = dj5 - dj3, x = dj6 - dj2;
+        R den = 1;
+        for (int i = 0; i <= dj4; ++i)
+            den *= R((dj2 + dj6 - dj4) / 2 + 1 + i) * R((dj3 + dj5 - dj4) / 2 + 1 + i);
+        const R sign = iphase(S);
+        if (y == -dj4)
         {
-            if (LSJcase == 1)
-            {
-                r = (J + m + 1) * (J - m) / den;
-            }
-            else if (LSJcase == 2)
+            const int m = (x + dj4) / 2;
+            R q = m == 0 || m == dj4 ? 1 : 2;
+            for (int i = 0; i < dj4 - m; ++i)
+                q *= R(S + 1 - i) * R(S - dj1 - i);
+            for (int i = 0; i < m; ++i)
+                q *= R(S - dj2 - i) * R(S - dj3 + 1 + i);
+            return static_cast<result_type>(sign * _sqrt(q / den));
+        }
+        // `{a b c; 1 c b}`, the only one left
+        const R X = R(dj2) * (dj2 + 2) + R(dj3) * (dj3 + 2) - R(dj1) * (dj1 + 2);
+        return static_cast<result_type>(-sign * X / (2 * _sqrt(den)));
+    }
+
+    // `f9j` of the arguments `d` in rows, permuted in place. Swapping two rows or two columns gives the phase
+    // `(-1)^(j1 + ... + j9)` and the transpose none. A 0 moves to `j9` and
+    // `{a b e; c d e; f f 0} = (-1)^(b+c+e+f) {a b e; d c f} / sqrt((2e+1)(2f+1))`. A line `(1/2, 1/2, S)` moves to
+    // `{l1 1/2 j1; l2 1/2 j2; L S J}` with integer `l1, l2, L`, which is `lsjj`, only if `result_type` is not more
+    // precise than `double`. Returns false if neither applies.
+    bool _f9j_reduced(int *d, result_type &out) const
+    {
+        const int phase = iphase((d[0] + d[1] + d[2] + d[3] + d[4] + d[5] + d[6] + d[7] + d[8]) / 2);
+        int sign = 1;
+        auto swap_rows = [&](int r, int s) {
+            if (r != s)
             {
-                r = -(p + 1 + J) * (p + 1 - J) / static_cast<double>(J * (2 * J + 1));
-                r *= (J + m + 1) * (J + m) / den;
+                std::swap_ranges(d + 3 * r, d + 3 * r + 3, d + 3 * s);
+                sign *= phase;
             }
-            else if (LSJcase == 3)
+        };
+        auto swap_columns = [&](int c, int s) {
+            if (c != s)
             {
-                r = (p + 1) * (p + 1) / static_cast<double>(J * (J + 1));
-                r *= (J + m + 1) * (J - m) / den;
+                for (int r = 0; r < 3; ++r)
+                    std::swap(d[3 * r + c], d[3 * r + s]);
+                sign *= phase;
             }
-            else if (LSJcase == 4)
+        };
+        for (int i = 0; i < 9; ++i)
+            if (d[i] == 0)
             {
-                r = -(p + 1 + L) * (p + 1 - L) / static_cast<double>(L * (2 * J + 1));
-                r *= (J - m + 1) * (J - m) / den;
+                swap_rows(i / 3, 2);
+                swap_columns(i % 3, 2);
+                out = sign * iphase((d[1] + d[3] + d[2] + d[6]) / 2) * f6j(d[0], d[1], d[2], d[4], d[3], d[6]) /
+                      _sqrt(result_type(d[2] + 1) * result_type(d[6] + 1));
+                return true;
             }
+        if constexpr (sizeof(result_type) > sizeof(double))
+            return false;
+        // two 1/2 in a row, or in a column after the transpose
+        auto halves = [&](int i, int step) { return (d[i] == 1) + (d[i + step] == 1) + (d[i + 2 * step] == 1) >= 2; };
+        int c = 0;
+        while (c < 3 && !halves(c, 3))
+            ++c;
+        if (c == 3)
+        {
+            int r = 0;
+            while (r < 3 && !halves(3 * r, 1))
+                ++r;
+            if (r == 3)
+                return false;
+            std::swap(d[1], d[3]), std::swap(d[2], d[6]), std::swap(d[5], d[7]);
+            c = r;
         }
-        else if (d1 == -1 && d2 == 1)
+        swap_columns(c, 1);
+        swap_rows(d[1] != 1 ? 0 : d[4] != 1 ? 1 : 2, 2);
+        if ((d[0] | d[3] | d[6]) & 1)
+            swap_columns(0, 2);
+        if ((d[0] | d[3] | d[6]) & 1)
+            return false;
+        out = static_cast<result_type>(sign * lsjj(d[0] / 2, d[3] / 2, d[2], d[5], d[6] / 2, d[7] / 2, d[8] / 2) /
+                                       std::sqrt((d[2] + 1.) * (d[5] + 1.) * (d[6] + 1.) * (d[7] + 1.)));
+        return true;
+    }
+
+    // `args` are `dj1, dj2, dj3, dm1, dm2, dm3`
+    template <bool Is3j>
+    void _batch(std::size_t n, std::array<const int *, 6> args, result_type *out) const
+    {
+        std::size_t i = 0;
+#ifdef JSHL_WIGNER_AVX2
+        if constexpr (std::is_same<T, double>::value && _has_binomial_rows<Binomial>::value)
         {
-            if (LSJcase == 1)
+            if (__builtin_cpu_supports("avx2"))
+                i = _batch_avx2<Is3j>(n, args, out);
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            const int dj1 = args[0][i], dj2 = args[1][i], dj3 = args[2][i];
+            const int dm1 = args[3][i], dm2 = args[4][i], dm3 = args[5][i];
+            out[i] = Is3j ? f3j(dj1, dj2, dj3, dm1, dm2, dm3) : CG(dj1, dj2, dj3, dm1, dm2, dm3);
+        }
+    }
+
+#ifdef JSHL_WIGNER_AVX2
+    // The same operations as the scalar `CG` and `f3j`, 4 lanes at a time. The arguments of invalid lanes are set to
+    // zero, so they read `binomial(0, 0)`, and their results are masked out. Returns how many symbols are done.
+    template <bool Is3j>
+    __attribute__((target("avx2"))) std::size_t _batch_avx2(std::size_t n, const std::array<const int *, 6> &args,
+                                                            double *out) const
+    {
+        using V = _avx2_ops;
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi32(1);
+        const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128i dj1 = V::load(args[0] + i), dj2 = V::load(args[1] + i), dj3 = V::load(args[2] + i);
+            __m128i dm1 = V::load(args[3] + i), dm2 = V::load(args[4] + i), dm3 = V::load(args[5] + i);
+            const __m128i sum_dm = _mm_add_epi32(dm1, dm2);
+            __m128i valid = _mm_and_si128(V::check_jm(dj1, dm1), V::check_jm(dj2, dm2));
+            valid = _mm_and_si128(valid, V::check_jm(dj3, dm3));
+            valid = _mm_and_si128(valid, Is3j ? _mm_cmpeq_epi32(sum_dm, _mm_sub_epi32(zero, dm3))
+                                              : _mm_cmpeq_epi32(sum_dm, dm3));
+            // `check_couple`, `dj3 >= 0` is checked by `check_jm`
+            const __m128i dj12 = _mm_add_epi32(dj1, dj2);
+            valid = _mm_and_si128(valid, _mm_and_si128(V::le(zero, dj1), V::le(zero, dj2)));
+            valid = _mm_and_si128(valid, _mm_and_si128(V::even(_mm_add_epi32(dj12, dj3)), V::le(dj3, dj12)));
+            valid = _mm_and_si128(valid, V::le(_mm_abs_epi32(_mm_sub_epi32(dj1, dj2)), dj3));
+            if (_mm_testz_si128(valid, valid))
             {
-                r = -(J + m) * (J - m + 1) / den;
+                _mm256_storeu_pd(out + i, _mm256_setzero_pd());
+                continue;
             }
-            else if (LSJcase == 2)
+            dj1 = _mm_and_si128(dj1, valid), dj2 = _mm_and_si128(dj2, valid), dj3 = _mm_and_si128(dj3, valid);
+            dm1 = _mm_and_si128(dm1, valid), dm2 = _mm_and_si128(dm2, valid), dm3 = _mm_and_si128(dm3, valid);
+            const __m128i J = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(dj1, dj2), dj3), 1);
+            _check_nmax(V::hmax(J) + 1);
+            const double *const *rows = _binomial.rows();
+            const __m128i jm1 = _mm_sub_epi32(J, dj1);
+            const __m128i jm2 = _mm_sub_epi32(J, dj2);
+            const __m128i jm3 = _mm_sub_epi32(J, dj3);
+            const __m128i j1mm1 = _mm_srai_epi32(_mm_sub_epi32(dj1, dm1), 1);
+            const __m128i j2mm2 = _mm_srai_epi32(_mm_sub_epi32(dj2, dm2), 1);
+            const __m128i j3mm3 = _mm_srai_epi32(_mm_sub_epi32(dj3, dm3), 1);
+            const __m128i J1 = _mm_add_epi32(J, one);
+            __m256d nu, de;
+            if constexpr (Is3j)
             {
-                r = (p + 1 + J) * (p + 1 - J) / static_cast<double>(J * (2 * J + 1));
-                r *= (J - m) * (J - m + 1) / den;
+                nu = _mm256_mul_pd(V::binomial(rows, dj1, jm2, all), V::binomial(rows, dj2, jm1, all));
+                de = _mm256_mul_pd(_mm256_cvtepi32_pd(J1), V::binomial(rows, J, jm3, all));
             }
-            else if (LSJcase == 3)
+            else
             {
-                r = (p + 1) * (p + 1) / static_cast<double>(J * (J + 1));
-                r *= (J + m) * (J - m + 1) / den;
+                nu = _mm256_mul_pd(V::binomial(rows, dj1, jm2, all), V::binomial(rows, dj2, jm3, all));
+                de = V::binomial(rows, J1, jm3, all);
             }
-            else if (LSJcase == 4)
+            de = _mm256_mul_pd(de, V::binomial(rows, dj1, j1mm1, all));
+            de = _mm256_mul_pd(de, V::binomial(rows, dj2, j2mm2, all));
+            de = _mm256_mul_pd(de, V::binomial(rows, dj3, j3mm3, all));
+            const __m256d A = _mm256_sqrt_pd(_mm256_div_pd(nu, de));
+            // the sum over `z` of `binomial(jm3, z) * binomial(jm2, a - z) * binomial(jm1, b - z)`
+            const __m128i a = Is3j ? _mm_srai_epi32(_mm_add_epi32(dj1, dm1), 1) : j1mm1;
+            const __m128i b = Is3j ? j2mm2 : _mm_srai_epi32(_mm_add_epi32(dj2, dm2), 1);
+            const __m128i low = _mm_max_epi32(zero, _mm_max_epi32(_mm_sub_epi32(a, jm2), _mm_sub_epi32(b, jm1)));
+            const __m128i high = _mm_min_epi32(jm3, _mm_min_epi32(a, b));
+            __m256d B = _mm256_setzero_pd();
+            for (int z = V::hmin(low), zh = V::hmax(high); z <= zh; ++z)
             {
-                r = (p + 1 + L) * (p + 1 - L) / static_cast<double>(L * (2 * J + 1));
-                r *= (J + m + 1) * (J + m) / den;
+                const __m128i vz = _mm_set1_epi32(z);
+                const __m256d active = V::widen(_mm_and_si128(V::le(low, vz), V::le(vz, high)));
+                __m256d t = _mm256_mul_pd(V::binomial(rows, jm3, vz, active),
+                                          V::binomial(rows, jm2, _mm_sub_epi32(a, vz), active));
+                t = _mm256_mul_pd(t, V::binomial(rows, jm1, _mm_sub_epi32(b, vz), active));
+                B = _mm256_blendv_pd(B, _mm256_sub_pd(t, B), active);
             }
+            __m128i p = high;
+            if constexpr (Is3j)
+                p = _mm_add_epi32(_mm_add_epi32(dj1, _mm_srai_epi32(_mm_add_epi32(dj3, dm3), 1)), high);
+            const __m256d r = _mm256_mul_pd(_mm256_mul_pd(V::phase(p), A), B);
+            _mm256_storeu_pd(out + i, _mm256_and_pd(r, V::widen(valid)));
         }
-        else if (d1 == -1 && d2 == -1)
+        return i;
+    }
+#endif
+
+    // no checks, `j1 + j2 + j3` is even and `nmax() >= j1 + j2 + j3 + 1`
+    template <typename Lookup>
+    result_type _CG0(const Lookup &bin, int j1, int j2, int j3) const
+    {
+        const int J = j1 + j2 + j3;
+        const int g = J / 2;
+        const T B = iphase(g - j3) * bin(g, j3) * bin(j3, g - j1);
+        if constexpr (_has_sqrt_binomial<Binomial>::value)
+            return static_cast<result_type>(B * _inv_sqrt_binomial(J + 1, 2 * j3 + 1) *
+                                            _inv_sqrt_binomial(2 * j3, J - 2 * j1));
+        else
+            return static_cast<result_type>(B / _sqrt(bin(J + 1, 2 * j3 + 1) * bin(2 * j3, J - 2 * j1)));
+    }
+
+    // The engine read by the lookups of one symbol, it is taken once at the entry and passed into the sums. For
+    // `NumaBinomialTable` this is the replica of the thread's node, so the node is not resolved for each binomial.
+    decltype(auto) _local_binomial() const
+    {
+        if constexpr (_has_local_binomial<Binomial>::value)
+            return _binomial.local();
+        else
+            return static_cast<const Binomial &>(_binomial);
+    }
+
+    // only for engines with the companion tables, see `SqrtBinomialTable`
+    T _sqrt_binomial(int n, int k) const { return _binomial.sqrt_binomial(n, k); }
+    T _inv_sqrt_binomial(int n, int k) const { return _binomial.inv_sqrt_binomial(n, k); }
+
+    void _check_nmax(int n) const
+    {
+        if (n > _binomial.nmax())
+            _reserve_nmax(n);
+    }
+
+    // the slow path of `_check_nmax`, `_binomial` is a thread safe cache, so it is `mutable`
+    void _reserve_nmax(int n) const
+    {
+        switch (reserve_mode())
         {
-            if (LSJcase == 1)
+            case ReserveMode::unchecked: break;
+            case ReserveMode::grow: _binomial.reserve(n); break;
+            case ReserveMode::error:
             {
-                r = (J + p + 1) * (p - J) / den;
+                std::cerr << "Error: need binomial table nmax = " << n << ", but nmax = " << nmax()
+                          << ", please reserve it first" << std::endl;
+                std::exit(-1);
             }
-            else if (LSJcase == 2)
+        }
+    }
+
+    mutable Binomial _binomial;
+    TriangleTable _triangle;
+    CG0Table<result_type> _CG0_table;
+    std::atomic<ReserveMode> _reserve_mode{ReserveMode::unchecked};
+    std::atomic<bool> _closed_forms{true};
+};
+
+using WignerSymbols = BasicWignerSymbols<double>;
+
+// For the smallest element at `p = 3r + k` of a Regge square, the positions of the other two elements of row `r`,
+// `x1` in column `k + 1` and `x2` in column `k + 2`, and of column `k`, `y1` in row `r + 1` and `y2` in row `r + 2`
+// (all mod 3), 4 bits each. The canonical square moves row `r` and column `k` first, then the column of the smaller
+// `x` and the row of the smaller `y`, and transposes if the smaller `y` is smaller than the smaller `x`. Either way its
+// center `u` is at the crossing of these two, the bits `16 + 4 * (x2 < x1) + 8 * (y2 < y1)` give its position. A
+// permutation of `0, 1, 2` whose second element follows the first one cyclically is even, so the row and column
+// permutations are odd for `(x2 < x1) ^ (y2 < y1)`.
+constexpr std::array<std::uint32_t, 9> _make_regge_moves()
+{
+    std::array<std::uint32_t, 9> moves{};
+    for (int p = 0; p < 9; ++p)
+    {
+        const int r = p / 3, k = p % 3;
+        const int r1 = (r + 1) % 3, r2 = (r + 2) % 3, k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+        std::uint32_t m = (3 * r + k1) | (3 * r + k2) << 4 | (3 * r1 + k) << 8 | (3 * r2 + k) << 12;
+        m |= (3 * r1 + k1) << 16 | (3 * r1 + k2) << 20 | (3 * r2 + k1) << 24 | std::uint32_t(3 * r2 + k2) << 28;
+        moves[p] = m;
+    }
+    return moves;
+}
+
+inline constexpr std::array<std::uint32_t, 9> _regge_moves = _make_regge_moves();
+
+// A table of the 3j symbols with `(dj1 + dj2 + dj3) / 2 <= Jmax()`, each one stored once for its 72 Regge
+// symmetries. The arguments are written as the Regge square
+//     -j1+j2+j3  j1-j2+j3  j1+j2-j3
+//     j1-m1      j2-m2     j3-m3
+//     j1+m1      j2+m2     j3+m3
+// whose rows and columns all sum to `J = j1 + j2 + j3`. Permuting the rows or the columns multiplies the symbol by
+// `(-1)^J` for an odd permutation, and the transpose leaves it unchanged. The canonical square has its smallest
+// element `S` on the top left, row 0 is `S, a, b` and column 0 is `S, c, d` with `a <= c <= d <= b`, then the square
+// is fixed by `J, S, a, c` and its center `u`, which are packed into a dense index, ordered by `J`. Larger symbols
+// fall back to `f3j`. Like the other tables it only grows, readers never take a lock.
+template <typename T>
+class Regge3jTable
+{
+  public:
+    using value_type = T;
+    using result_type = typename _wigner_result<T>::type;
+
+    Regge3jTable() : Regge3jTable(TablePolicy{}) {}
+    explicit Regge3jTable(TablePolicy policy) : _data(&_empty), _wigner(policy), _policy(policy)
+    {
+        _wigner.set_reserve_mode(ReserveMode::grow);
+    }
+    Regge3jTable(const Regge3jTable &other) : Regge3jTable(other.policy()) { reserve(other.djmax()); }
+    Regge3jTable &operator=(const Regge3jTable &) = delete;
+
+    // the largest `J = (dj1 + dj2 + dj3) / 2` in the table, -1 if it is empty
+    int Jmax() const { return _data.load(std::memory_order_acquire)->Jmax; }
+    // the `djmax` of the last `reserve`, all symbols with `dj <= djmax()` are in the table
+    int djmax() const { return _data.load(std::memory_order_acquire)->djmax; }
+    TablePolicy policy() const { return _policy; }
+
+    // number of stored values for `Jmax`
+    static std::size_t size(int Jmax)
+    {
+        std::size_t n = 0;
+        for (int J = 0; J <= Jmax; ++J)
+            for (int S = 0; 3 * S <= J; ++S)
+                n += _count(J, S);
+        return n;
+    }
+    // bytes that `reserve(djmax)` needs, for example about 1MB for `djmax = 30` and 22MB for `djmax = 60` with double
+    static std::size_t memory(int djmax)
+    {
+        const int Jmax = 3 * djmax / 2;
+        return size(Jmax) * sizeof(result_type) + (Jmax + 1) * (Jmax / 3 + 1) * sizeof(std::size_t);
+    }
+    // bytes used by the table, without the blocks it has outgrown
+    std::size_t memory() const { return djmax() < 0 ? 0 : memory(djmax()); }
+
+    result_type f3j(int dj1, int dj2, int dj3, int dm1, int dm2, int dm3) const
+    {
+        if (!(_check_jm(dj1, dm1) && _check_jm(dj2, dm2) && _check_jm(dj3, dm3)))
+            return 0;
+        if (!TriangleTable::check(dj1, dj2, dj3))
+            return 0;
+        if (dm1 + dm2 + dm3 != 0)
+            return 0;
+        const _table *table = _data.load(std::memory_order_acquire);
+        const int J = (dj1 + dj2 + dj3) / 2;
+        if (J > table->Jmax)
+            return _wigner.f3j(dj1, dj2, dj3, dm1, dm2, dm3);
+        // all elements are non negative, the shifts are the divisions by 2
+        const int R[9] = {J - dj1, J - dj2, J - dj3, (dj1 - dm1) >> 1, (dj2 - dm2) >> 1, (dj3 - dm3) >> 1,
+                          (dj1 + dm1) >> 1, (dj2 + dm2) >> 1, (dj3 + dm3) >> 1};
+        // The smallest element `S` and its position `p` in one key, the first one if there are more. The keys are
+        // computed from the arguments, a loop over `R` is about 2 times slower unless it is vectorized.
+        const int key = _min(_min(_min((J - dj1) << 4, ((J - dj2) << 4) | 1),
+                                  _min(((J - dj3) << 4) | 2, ((dj1 - dm1) << 3) | 3)),
+                             _min(_min(((dj2 - dm2) << 3) | 4, ((dj3 - dm3) << 3) | 5),
+                                  _min(((dj1 + dm1) << 3) | 6, _min(((dj2 + dm2) << 3) | 7, ((dj3 + dm3) << 3) | 8))));
+        const int S = key >> 4, p = key & 15;
+        // the other elements of the row and column of `S`, see `_make_regge_moves`
+        const std::uint32_t move = _regge_moves[p];
+        const int x1 = R[move & 15], x2 = R[(move >> 4) & 15], y1 = R[(move >> 8) & 15], y2 = R[(move >> 12) & 15];
+        const int kx = x2 < x1, ky = y2 < y1;
+        const int u = R[(move >> (16 + 4 * (kx + 2 * ky))) & 15];
+        const int a = _min(_min(x1, x2), _min(y1, y2));
+        const int c = _max(_min(x1, x2), _min(y1, y2));
+        const unsigned e = a - S, f = c - a, t = u - (J - c - a), h = (J - 3 * S) >> 1;
+        const std::size_t i =
+            table->offsets[J * table->sdim + S] + e * (e + 1) * (3 * h + 5 - 2 * e) / 6 + f * (e + 1) + t;
+        return static_cast<result_type>(1 - 2 * ((kx ^ ky) & J)) * table->values[i];
+    }
+
+    // `CG(j1 m1 j2 m2 | j3 m3)` from the table
+    result_type CG(int dj1, int dj2, int dj3, int dm1, int dm2, int dm3) const
+    {
+        const result_type x = f3j(dj1, dj2, dj3, dm1, dm2, -dm3);
+        if (x == 0)
+            return 0;
+        const result_type y = x * static_cast<result_type>(_sqrt(T(dj3 + 1)));
+        return ((dj1 - dj2 + dm3) / 2) % 2 != 0 ? -y : y;
+    }
+
+    // Fill the table for all `dj <= djmax`, that is `Jmax = 3 * djmax / 2`. The values of the smaller `J` are
+    // copied from the current table, only the new ones are computed by `f3j`.
+    void reserve(int djmax)
+    {
+        if (djmax <= this->djmax())
+            return;
+        std::lock_guard<std::mutex> lock(_grow_mutex);
+        const _table *old = _data.load(std::memory_order_relaxed);
+        if (djmax <= old->djmax)
+            return;
+        const int Jmax = 3 * djmax / 2;
+        if (size(Jmax) > std::numeric_limits<int>::max())
+        {
+            std::cerr << "Error: djmax too large" << std::endl;
+            std::exit(-1);
+        }
+        std::unique_ptr<_table> table(new _table);
+        table->Jmax = Jmax;
+        table->djmax = djmax;
+        table->sdim = Jmax / 3 + 1;
+        table->offsets.reset(new std::size_t[(Jmax + 1) * table->sdim]);
+        std::size_t n = 0;
+        for (int J = 0; J <= Jmax; ++J)
+        {
+            for (int S = 0; 3 * S <= J; ++S)
             {
-                r = -(J + m) * (J - m) / static_cast<double>(J * (2 * J + 1));
-                r *= (p - J) * (p + 1 - J) / den;
+                table->offsets[J * table->sdim + S] = n;
+                n += _count(J, S);
             }
-            else if (LSJcase == 3)
+        }
+        table->values = _allocate_table<result_type>(n, _policy);
+        const std::size_t n_old = old->Jmax < 0 ? 0 : size(old->Jmax);
+        std::copy(old->values.get(), old->values.get() + n_old, table->values.get());
+        _wigner.reserve(Jmax + 1, "nmax", 0);
+        result_type *x = table->values.get() + n_old;
+        for (int J = old->Jmax + 1; J <= Jmax; ++J)
+        {
+            for (int S = 0; 3 * S <= J; ++S)
             {
-                if (m == 0)
-                    return 0.0;
-                r = -m * std::abs(m) / static_cast<double>(J * (J + 1));
-                r *= (J + p + 1) * (p - J) / den;
+                const int h = (J - 3 * S) / 2;
+                for (int a = S; a <= S + h; ++a)
+                {
+                    for (int c = a; c <= S + h; ++c)
+                    {
+                        const int d = J - S - c;
+                        for (int u = S + d - a; u <= d; ++u)
+                        {
+                            const int v = J - c - u, w = J - a - u, z = a + u - d;
+                            *x++ = _wigner.f3j(c + d, u + w, v + z, d - c, w - u, z - v);
+                        }
+                    }
+                }
             }
-            else if (LSJcase == 4)
+        }
+        if (!_blocks)
+            _blocks.reset(new std::vector<std::unique_ptr<_table>>);
+        _blocks->push_back(std::move(table));
+        _data.store(_blocks->back().get(), std::memory_order_release);
+    }
+
+  private:
+    struct _table
+    {
+        int Jmax = -1;
+        int djmax = -1;
+        int sdim = 0;
+        std::unique_ptr<std::size_t[]> offsets;
+        _table_ptr<result_type> values;
+    };
+
+    // the squares of `J` with the smallest element `S`, that is `binomial(h + 3, 3)` for `h = (J - 3S) / 2`
+    static std::size_t _count(int J, int S)
+    {
+        const std::size_t h = (J - 3 * S) / 2;
+        return (h + 1) * (h + 2) * (h + 3) / 6;
+    }
+    static bool _check_jm(int dj, int dm) { return ((dj ^ dm) & 1) == 0 && std::abs(dm) <= dj; }
+    // by value, `std::min` returns a reference and is often compiled to branches, which the random squares miss
+    static int _min(int x, int y) { return x < y ? x : y; }
+    static int _max(int x, int y) { return x < y ? y : x; }
+
+    static inline const _table _empty{};
+
+    std::atomic<const _table *> _data;
+    BasicWignerSymbols<T> _wigner;
+    TablePolicy _policy;
+    std::mutex _grow_mutex;
+    // allocated by the first `reserve`
+    std::unique_ptr<std::vector<std::unique_ptr<_table>>> _blocks;
+};
+
+// The unitary change of basis from the product states `|j1 m1, j2 m2>` to the coupled states `|J M>`, stored as its
+// blocks of `M = m1 + m2`, without the zeros between them. The product states are ordered like `CG_block`,
+// `(dj1 + dm1) / 2 * (dj2 + 1) + (dj2 + dm2) / 2`, and the coupled states by `J` then `M`, see `coupled_index`. The
+// block of `M` is a square matrix with the rows `J = max(|M|, |j1 - j2|) .. j1 + j2` and the columns
+// `m1 = max(-j1, M - j2) .. min(j1, M + j2)`, its entries are `<j1 m1; j2 M - m1|J M>`. So `|J M> = sum U |m1 m2>`.
+template <typename T>
+class CouplingMatrix
+{
+  public:
+    using value_type = T;
+    using result_type = typename _wigner_result<T>::type;
+
+    // the blocks are filled with the recursions of `CG_block`, one triad at a time
+    CouplingMatrix(int dj1, int dj2) : _dj1(dj1), _dj2(dj2)
+    {
+        if (dj1 < 0 || dj2 < 0)
+        {
+            std::cerr << "Error: CouplingMatrix needs dj1 >= 0 and dj2 >= 0" << std::endl;
+            std::exit(-1);
+        }
+        const int nM = dj1 + dj2 + 1;
+        _offsets.resize(nM + 1);
+        _first.resize(nM + 1);
+        _offsets[0] = 0;
+        _first[0] = 0;
+        for (int k = 0; k < nM; ++k)
+        {
+            _offsets[k + 1] = _offsets[k] + std::size_t(_size(k)) * _size(k);
+            _first[k + 1] = _first[k] + _size(k);
+        }
+        _values.resize(_offsets[nM]);
+        _product.resize(dim());
+        _coupled.resize(dim());
+        for (int k = 0; k < nM; ++k)
+        {
+            // `k = i1 + i2` for `i1 = (dj1 + dm1) / 2` and `i2 = (dj2 + dm2) / 2`
+            const int low = std::max(0, k - dj2);
+            for (int b = 0; b < _size(k); ++b)
+                _product[_first[k] + b] = (low + b) * (dj2 + 1) + k - low - b;
+            const int dM = 2 * k - dj1 - dj2, dJmin = std::max(std::abs(dM), std::abs(dj1 - dj2));
+            for (int a = 0; a < _size(k); ++a)
+                _coupled[_first[k] + a] = coupled_index(dJmin + 2 * a, dM);
+        }
+        const BasicWignerSymbols<T> wigner;
+        std::vector<result_type> block((dj1 + 1) * (dj2 + 1));
+        for (int dJ = std::abs(dj1 - dj2); dJ <= dj1 + dj2; dJ += 2)
+        {
+            wigner.CG_block(dj1, dj2, dJ, block.data());
+            for (int dM = -dJ; dM <= dJ; dM += 2)
             {
-                r = (L + m) * (L - m) / static_cast<double>(L * (2 * J + 1));
-                r *= (J + p + 1) * (J + p + 2) / den;
+                const int k = (dM + dj1 + dj2) / 2, a = (dJ - std::max(std::abs(dM), std::abs(dj1 - dj2))) / 2;
+                result_type *row = _values.data() + _offsets[k] + std::size_t(a) * _size(k);
+                for (int b = 0; b < _size(k); ++b)
+                    row[b] = block[_product[_first[k] + b]];
             }
         }
+    }
 
-        return std::copysign(std::sqrt(std::abs(r)), r);
+    int dj1() const { return _dj1; }
+    int dj2() const { return _dj2; }
+    // `(dj1 + 1) * (dj2 + 1)`, the number of states
+    int dim() const { return (_dj1 + 1) * (_dj2 + 1); }
+    std::size_t memory() const
+    {
+        const std::size_t n = _product.size() + _coupled.size() + _first.size();
+        return _values.size() * sizeof(result_type) + n * sizeof(int) + _offsets.size() * sizeof(std::size_t);
     }
 
-    double _m9j(int j1, int j2, int j3, int j4, int j5, int j6, int j7, int j8, int j9) const
+    // no range checks, the arguments must be allowed
+    int product_index(int dm1, int dm2) const { return (_dj1 + dm1) / 2 * (_dj2 + 1) + (_dj2 + dm2) / 2; }
+    int coupled_index(int dJ, int dM) const
     {
-        const int j123 = j1 + j2 + j3;
-        const int j456 = j4 + j5 + j6;
-        const int j789 = j7 + j8 + j9;
-        const int j147 = j1 + j4 + j7;
-        const int j258 = j2 + j5 + j8;
-        const int j369 = j3 + j6 + j9;
-        const int pm123 = j1 + j2 - j3;
-        const int pm132 = j1 + j3 - j2;
-        const int pm231 = j2 + j3 - j1;
-        const int pm456 = j4 + j5 - j6;
-        const int pm465 = j4 + j6 - j5;
-        const int pm564 = j5 + j6 - j4;
-        const int pm789 = j7 + j8 - j9;
-        const int pm798 = j7 + j9 - j8;
-        const int pm897 = j8 + j9 - j7;
-        double sum = 0.0;
-        const int tl = std::max(std::abs(j2 - j6), std::max(std::abs(j4 - j8), std::abs(j1 - j9)));
-        const int th = std::min(j2 + j6, std::min(j4 + j8, j1 + j9));
-        for (int t = tl; t <= th; ++t)
+        const int d0 = std::abs(_dj1 - _dj2), k = (dJ - d0) / 2;
+        return k * (d0 + k) + (dJ + dM) / 2;
+    }
+
+    // the block of `dM`, `block_size(dM)^2` numbers, row `(dJ - max(|dM|, |dj1 - dj2|)) / 2` is `dJ`, column
+    // `(dj1 + dm1) / 2 - max(0, (dj1 + dj2 + dM) / 2 - dj2)` is `dm1`
+    int block_size(int dM) const { return _size((dM + _dj1 + _dj2) / 2); }
+    const result_type *block(int dM) const { return _values.data() + _offsets[(dM + _dj1 + _dj2) / 2]; }
+
+    // `<j1 m1; j2 m2|J m1 + m2>` from the blocks, 0 if it is not allowed
+    result_type operator()(int dJ, int dm1, int dm2) const
+    {
+        const int dM = dm1 + dm2;
+        if (!(_check_jm(_dj1, dm1) && _check_jm(_dj2, dm2) && _check_jm(dJ, dM)))
+            return 0;
+        if (dJ < std::abs(_dj1 - _dj2) || dJ > _dj1 + _dj2)
+            return 0;
+        const int a = (dJ - std::max(std::abs(dM), std::abs(_dj1 - _dj2))) / 2;
+        const int b = (_dj1 + dm1) / 2 - std::max(0, (_dj1 + _dj2 + dM) / 2 - _dj2);
+        return block(dM)[a * block_size(dM) + b];
+    }
+
+    // `y = U x`, `x` holds `ncol` vectors of the product basis in the rows, `dim() * ncol` numbers in row major, and
+    // `y` the same vectors in the coupled basis
+    void apply(const result_type *x, result_type *y, int ncol = 1) const { _left<false>(x, y, ncol); }
+    // `x = U^T y`, from the coupled basis back to the product basis
+    void apply_transpose(const result_type *y, result_type *x, int ncol = 1) const { _left<true>(y, x, ncol); }
+
+    // `b = U a U^T`, a dense `dim() * dim()` operator in row major from the product basis to the coupled basis, `a`
+    // needs not conserve `M`
+    void transform(const result_type *a, result_type *b) const
+    {
+        std::vector<result_type> tmp(std::size_t(dim()) * dim());
+        _left<false>(a, tmp.data(), dim());
+        _right<false>(tmp.data(), b);
+    }
+    // `a = U^T b U`, from the coupled basis back to the product basis
+    void transform_back(const result_type *b, result_type *a) const
+    {
+        std::vector<result_type> tmp(std::size_t(dim()) * dim());
+        _left<true>(b, tmp.data(), dim());
+        _right<true>(tmp.data(), a);
+    }
+
+  private:
+    // the number of states in the block `k = M + j1 + j2`, `min(k, dj1, dj2, dj1 + dj2 - k) + 1`
+    int _size(int k) const { return std::min(std::min(k, _dj1 + _dj2 - k), std::min(_dj1, _dj2)) + 1; }
+    static bool _check_jm(int dj, int dm) { return ((dj ^ dm) & 1) == 0 && std::abs(dm) <= dj; }
+
+    // the rows `in[pin[b]]` of each block to the rows `out[pout[a]]`, the inner loop runs over the `ncol` contiguous
+    // columns
+    template <bool Transpose>
+    void _left(const result_type *in, result_type *out, int ncol) const
+    {
+        const int *pin = Transpose ? _coupled.data() : _product.data();
+        const int *pout = Transpose ? _product.data() : _coupled.data();
+        for (int k = 0; k <= _dj1 + _dj2; ++k)
         {
-            const int j19t = j1 + j9 + t;
-            const int j26t = j2 + j6 + t;
-            const int j48t = j4 + j8 + t;
-            const int dt = 2 * t;
-            double Pt_de = unsafe_binomial(j19t + 1, dt + 1) * unsafe_binomial(dt, j1 + t - j9) *
-                           unsafe_binomial(j26t + 1, dt + 1) * unsafe_binomial(dt, j2 + t - j6) *
-                           unsafe_binomial(j48t + 1, dt + 1) * unsafe_binomial(dt, j4 + t - j8);
-            Pt_de *= (dt + 1) * (dt + 1);
-            const int xl = std::max(j123, std::max(j369, std::max(j26t, j19t)));
-            const int xh = std::min(pm123 + j369, std::min(pm132 + j26t, pm231 + j19t));
-            double At = 0.0;
-            for (int x = xl; x <= xh; ++x)
+            const int n = _size(k);
+            const result_type *u = _values.data() + _offsets[k];
+            for (int a = 0; a < n; ++a)
             {
-                At = -At + unsafe_binomial(x + 1, j123 + 1) * unsafe_binomial(pm123, x - j369) *
-                               unsafe_binomial(pm132, x - j26t) * unsafe_binomial(pm231, x - j19t);
+                result_type *y = out + std::size_t(pout[_first[k] + a]) * ncol;
+                std::fill(y, y + ncol, result_type(0));
+                for (int b = 0; b < n; ++b)
+                {
+                    const result_type c = Transpose ? u[b * n + a] : u[a * n + b];
+                    const result_type *x = in + std::size_t(pin[_first[k] + b]) * ncol;
+                    for (int j = 0; j < ncol; ++j)
+                        y[j] += c * x[j];
+                }
             }
-            const int yl = std::max(j456, std::max(j26t, std::max(j258, j48t)));
-            const int yh = std::min(pm456 + j26t, std::min(pm465 + j258, pm564 + j48t));
-            double Bt = 0.0;
-            for (int y = yl; y <= yh; ++y)
+        }
+    }
+
+    // `out = in U^T` for `Transpose = false` and `out = in U` otherwise, on the columns of the `dim()` rows
+    template <bool Transpose>
+    void _right(const result_type *in, result_type *out) const
+    {
+        const int *pin = Transpose ? _coupled.data() : _product.data();
+        const int *pout = Transpose ? _product.data() : _coupled.data();
+        const int d = dim();
+        for (int r = 0; r < d; ++r)
+        {
+            const result_type *x = in + std::size_t(r) * d;
+            result_type *y = out + std::size_t(r) * d;
+            for (int k = 0; k <= _dj1 + _dj2; ++k)
             {
-                Bt = -Bt + unsafe_binomial(y + 1, j456 + 1) * unsafe_binomial(pm456, y - j26t) *
-                               unsafe_binomial(pm465, y - j258) * unsafe_binomial(pm564, y - j48t);
+                const int n = _size(k);
+                const result_type *u = _values.data() + _offsets[k];
+                for (int a = 0; a < n; ++a)
+                {
+                    result_type s = 0;
+                    for (int b = 0; b < n; ++b)
+                        s += (Transpose ? u[b * n + a] : u[a * n + b]) * x[pin[_first[k] + b]];
+                    y[pout[_first[k] + a]] = s;
+                }
             }
-            const int zl = std::max(j789, std::max(j19t, std::max(j48t, j147)));
-            const int zh = std::min(pm789 + j19t, std::min(pm798 + j48t, pm897 + j147));
-            double Ct = 0.0;
-            for (int z = zl; z <= zh; ++z)
+        }
+    }
+
+    int _dj1, _dj2;
+    // the start of the block `k = M + j1 + j2` in `_values`
+    std::vector<std::size_t> _offsets;
+    // the first state of the block `k` in `_product` and `_coupled`
+    std::vector<int> _first;
+    std::vector<result_type> _values;
+    // the product and coupled indices of the columns and rows of the blocks, one block after another
+    std::vector<int> _product, _coupled;
+};
+
+// The orthogonal recoupling matrix of three angular momenta with a fixed total `J`,
+// `R(J12, J23) = <(j1 j2)J12, j3; J|j1, (j2 j3)J23; J>`
+// `            = (-1)^(j1+j2+j3+J) sqrt((2J12+1)(2J23+1)) {j1 j2 J12; j3 J J23}`,
+// for all `J12 = max(|j1 - j2|, |j3 - J|) .. min(j1 + j2, j3 + J)` in the rows and all
+// `J23 = max(|j2 - j3|, |j1 - J|) .. min(j2 + j3, j1 + J)` in the columns, both `dim()` long. It is one dense array
+// with the leading dimension `dim()`, in row major or column major, so `data()` can be passed to BLAS as it is. Each
+// row or column is one `f6j_range`, written in place, so the matrix needs no binomial table and costs O(1) per entry.
+template <typename T>
+class RecouplingMatrix
+{
+  public:
+    using value_type = T;
+    using result_type = typename _wigner_result<T>::type;
+
+    RecouplingMatrix(int dj1, int dj2, int dj3, int dJ, bool column_major = false)
+    {
+        assign(dj1, dj2, dj3, dJ, column_major);
+    }
+
+    // refill for other arguments, the storage is reused when it is large enough
+    void assign(int dj1, int dj2, int dj3, int dJ, bool column_major = false)
+    {
+        if (dj1 < 0 || dj2 < 0 || dj3 < 0 || dJ < 0)
+        {
+            std::cerr << "Error: RecouplingMatrix needs dj1, dj2, dj3, dJ >= 0" << std::endl;
+            std::exit(-1);
+        }
+        _dj1 = dj1, _dj2 = dj2, _dj3 = dj3, _dJ = dJ, _column_major = column_major;
+        _dJ12min = std::max(std::abs(dj1 - dj2), std::abs(dj3 - dJ));
+        _dJ23min = std::max(std::abs(dj2 - dj3), std::abs(dj1 - dJ));
+        const int dJ12max = std::min(dj1 + dj2, dj3 + dJ);
+        _dim = ((dj1 + dj2 + dj3 + dJ) & 1) || dJ12max < _dJ12min ? 0 : (dJ12max - _dJ12min) / 2 + 1;
+        _values.resize(std::size_t(_dim) * _dim);
+        if (_dim == 0)
+            return;
+        const BasicWignerSymbols<T> wigner;
+        // the factors `sqrt(2J + 1)` of the rows and the columns, with the phase on the rows
+        std::vector<result_type> rows(_dim), cols(_dim);
+        const result_type sign = (dj1 + dj2 + dj3 + dJ) / 2 % 2 ? -1 : 1;
+        for (int k = 0; k < _dim; ++k)
+        {
+            rows[k] = sign * _sqrt(result_type(_dJ12min + 2 * k + 1));
+            cols[k] = _sqrt(result_type(_dJ23min + 2 * k + 1));
+        }
+        for (int k = 0; k < _dim; ++k)
+        {
+            result_type *line = _values.data() + std::size_t(k) * _dim;
+            if (column_major)
             {
-                Ct = -Ct + unsafe_binomial(z + 1, j789 + 1) * unsafe_binomial(pm789, z - j19t) *
-                               unsafe_binomial(pm798, z - j48t) * unsafe_binomial(pm897, z - j147);
+                // the column of `J23` is `{J12 j1 j2; J23 j3 J}`
+                wigner.f6j_range(dj1, dj2, _dJ23min + 2 * k, dj3, dJ, line);
+                for (int i = 0; i < _dim; ++i)
+                    line[i] *= rows[i] * cols[k];
+            }
+            else
+            {
+                // the row of `J12` is `{J23 j3 j2; J12 j1 J}`
+                wigner.f6j_range(dj3, dj2, _dJ12min + 2 * k, dj1, dJ, line);
+                for (int i = 0; i < _dim; ++i)
+                    line[i] *= rows[k] * cols[i];
             }
-            sum += iphase(xh + yh + zh) * At * Bt * Ct / Pt_de;
         }
-        return sum;
     }
 
-    // Buck et al. Nuc. Phys. A 600 (1996) 387-402
-    double Moshinsky(int N, int L, int n, int l, int n1, int l1, int n2, int l2, int lambda,
-                     double tan_beta = 1.0) const
+    int dj1() const { return _dj1; }
+    int dj2() const { return _dj2; }
+    int dj3() const { return _dj3; }
+    int dJ() const { return _dJ; }
+    // the number of `J12` and of `J23`, 0 if `J` is not allowed
+    int dim() const { return _dim; }
+    int dJ12min() const { return _dJ12min; }
+    int dJ23min() const { return _dJ23min; }
+    bool column_major() const { return _column_major; }
+    // `R(J12, J23)` is `data()[a * dim() + b]` in row major and `data()[b * dim() + a]` in column major, for
+    // `a = (dJ12 - dJ12min()) / 2` and `b = (dJ23 - dJ23min()) / 2`
+    const result_type *data() const { return _values.data(); }
+
+    // `R(J12, J23)`, no range checks, the arguments must be allowed
+    result_type operator()(int dJ12, int dJ23) const
     {
-        if (!check_couple_int(L, l, lambda) || !check_couple_int(l1, l2, lambda))
-            return 0.0;
-        // check energy conservation
-        const int e1 = 2 * n1 + l1;
-        const int e2 = 2 * n2 + l2;
-        const int E = 2 * N + L;
-        const int e = 2 * n + l;
-        if (e1 + e2 != e + E)
-            return 0;
+        const int a = (dJ12 - _dJ12min) / 2, b = (dJ23 - _dJ23min) / 2;
+        return _column_major ? _values[std::size_t(b) * _dim + a] : _values[std::size_t(a) * _dim + b];
+    }
 
-        const int nl1 = n1 + l1;
-        const int nl2 = n2 + l2;
-        const int NL = N + L;
-        const int nl = n + l;
-        const int chi = e1 + e2;
+    // `y = R x`, `x` holds `ncol` vectors in the basis of `J23` in the rows, `dim() * ncol` numbers in row major, and
+    // `y` the same vectors in the basis of `J12`
+    void apply(const result_type *x, result_type *y, int ncol = 1) const { _multiply(_column_major, x, y, ncol); }
+    // `x = R^T y`, from the basis of `J12` to the basis of `J23`
+    void apply_transpose(const result_type *y, result_type *x, int ncol = 1) const
+    {
+        _multiply(!_column_major, y, x, ncol);
+    }
 
-        const double cos_beta = 1.0 / std::sqrt(1.0 + tan_beta * tan_beta);
-        const double sin_beta = tan_beta * cos_beta;
-        double pre = unsafe_binomial(chi + 2, e1 + 1) / unsafe_binomial(chi + 2, E + 1);
-        pre *= unsafe_binomial(L + l + lambda + 1, 2 * lambda + 1) * unsafe_binomial(2 * lambda, lambda + L - l);
-        pre /= unsafe_binomial(l1 + l2 + lambda + 1, 2 * lambda + 1) * unsafe_binomial(2 * lambda, lambda + l1 - l2);
+  private:
+    // `out = A in` for the row major `A = _values` or its transpose, the inner loop runs over the `ncol` contiguous
+    // columns
+    void _multiply(bool transpose, const result_type *in, result_type *out, int ncol) const
+    {
+        std::fill(out, out + std::size_t(_dim) * ncol, result_type(0));
+        for (int a = 0; a < _dim; ++a)
+            for (int b = 0; b < _dim; ++b)
+            {
+                const std::size_t i = transpose ? std::size_t(b) * _dim + a : std::size_t(a) * _dim + b;
+                const result_type c = _values[i];
+                const result_type *x = in + std::size_t(b) * ncol;
+                result_type *y = out + std::size_t(a) * ncol;
+                for (int j = 0; j < ncol; ++j)
+                    y[j] += c * x[j];
+            }
+    }
 
-        pre *= (2 * l1 + 1) * unsafe_binomial(2 * nl1 + 1, nl1) / (unsafe_binomial(e1 + 1, n1) * quick_pow(2.0, l1));
-        pre *= (2 * l2 + 1) * unsafe_binomial(2 * nl2 + 1, nl2) / (unsafe_binomial(e2 + 1, n2) * quick_pow(2.0, l2));
-        pre *= (2 * L + 1) * unsafe_binomial(2 * NL + 1, NL) / (unsafe_binomial(E + 1, N) * quick_pow(2.0, L));
-        pre *= (2 * l + 1) * unsafe_binomial(2 * nl + 1, nl) / (unsafe_binomial(e + 1, n) * quick_pow(2.0, l));
-        pre = std::sqrt(pre) / ((e1 + 2) * (e2 + 2));
+    int _dj1 = 0, _dj2 = 0, _dj3 = 0, _dJ = 0, _dim = 0, _dJ12min = 0, _dJ23min = 0;
+    bool _column_major = false;
+    std::vector<result_type> _values;
+};
 
-        double sum = 0.0;
-        for (int ea = 0; ea <= std::min(e1, E); ++ea)
+// The nonzero Gaunt coefficients `Gaunt(l1, l2, l3, m1, m2, -m1 - m2)` of all `l1, l2 <= lmax`, stored like a sparse
+// matrix in rows (CSR). Row `lm(l1, m1) * (lmax + 1)^2 + lm(l2, m2)` for `lm(l, m) = l(l+1)+m` holds the allowed `l3`,
+// `max(|l1 - l2|, |m1 + m2|) <= l3 <= l1 + l2` with `l1 + l2 + l3` even, in increasing order, so all the coefficients
+// of a product `Y_{l1 m1} Y_{l2 m2}` are read in one pass over `l3()` and `values()`. The symmetries are not used,
+// the table needs about `lmax^5 / 2` entries, for example 7.8MB for `lmax = 16` with double.
+template <typename T>
+class GauntTable
+{
+  public:
+    using value_type = T;
+    using result_type = typename _wigner_result<T>::type;
+
+    // Each row is `CG0_range` of `l1, l2` times `f3j_range` of `l1, l2, m1, m2`, only the allowed values are computed
+    // and no zeros are stored.
+    explicit GauntTable(int lmax) : _lmax(lmax)
+    {
+        if (lmax < 0)
         {
-            const int eb = e1 - ea;
-            const int ec = E - ea;
-            const int ed = e2 - ec;
-            if (ed < 0)
-                continue;
-            const double tfa = quick_pow(sin_beta, ea + ed) * quick_pow(cos_beta, eb + ec) *
-                               unsafe_binomial(e1 + 2, ea + 1) * unsafe_binomial(e2 + 2, ec + 1);
-            for (int la = ea & 0x01; la <= ea; la += 2)
+            std::cerr << "Error: GauntTable needs lmax >= 0" << std::endl;
+            std::exit(-1);
+        }
+        const int n = (lmax + 1) * (lmax + 1);
+        BasicWignerSymbols<T> wigner;
+        wigner.reserve(4 * lmax + 1, "nmax", 0);
+        // `(-1)^(l1-l2) CG0(l1, l2, |l1-l2| + 2k) sqrt((2l1+1)(2l2+1)/(4pi))` at `(l1 * (lmax+1) + l2) * (lmax+1) + k`
+        std::vector<result_type> f0((lmax + 1) * (lmax + 1) * (lmax + 1));
+        for (int l1 = 0; l1 <= lmax; ++l1)
+        {
+            for (int l2 = 0; l2 <= lmax; ++l2)
             {
-                const int na = (ea - la) / 2;
-                const int nla = na + la;
-                const double _ta =
-                    quick_pow(2, la) * (2 * la + 1) * unsafe_binomial(ea + 1, na) / unsafe_binomial(2 * nla + 1, nla);
-                const double ta = tfa * _ta;
-                for (int lb = std::abs(l1 - la); lb <= std::min(l1 + la, eb); lb += 2)
+                result_type *row = f0.data() + (l1 * (lmax + 1) + l2) * (lmax + 1);
+                const int count = wigner.CG0_range(l1, l2, row);
+                const result_type factor = wigner.iphase(l1 - l2) * _Gaunt_factor<T>(l1, l2);
+                for (int k = 0; k < count; ++k)
+                    row[k] *= factor;
+            }
+        }
+        _offsets.reserve(std::size_t(n) * n + 1);
+        _offsets.push_back(0);
+        std::vector<result_type> f(2 * lmax + 1);
+        for (int l1 = 0; l1 <= lmax; ++l1)
+        {
+            for (int m1 = -l1; m1 <= l1; ++m1)
+            {
+                for (int l2 = 0; l2 <= lmax; ++l2)
                 {
-                    const int nb = (eb - lb) / 2;
-                    const int nlb = nb + lb;
-                    const double _tb = quick_pow(2, lb) * (2 * lb + 1) * unsafe_binomial(eb + 1, nb) /
-                                       unsafe_binomial(2 * nlb + 1, nlb);
-                    const int g1 = (la + lb + l1) / 2;
-                    const double t1 = unsafe_binomial(g1, l1) * unsafe_binomial(l1, g1 - la);
-                    const double tb = ta * _tb * t1;
-                    for (int lc = std::abs(L - la); lc <= std::min(L + la, ec); lc += 2)
+                    const result_type *row = f0.data() + (l1 * (lmax + 1) + l2) * (lmax + 1);
+                    for (int m2 = -l2; m2 <= l2; ++m2)
                     {
-                        const int nc = (ec - lc) / 2;
-                        const int nlc = nc + lc;
-                        const double _tc = quick_pow(2, lc) * (2 * lc + 1) * unsafe_binomial(ec + 1, nc) /
-                                           unsafe_binomial(2 * nlc + 1, nlc);
-                        const int g3 = (la + lc + L) / 2;
-                        const double t3 = unsafe_binomial(g3, L) * unsafe_binomial(L, g3 - la);
-                        const double d3 = (2 * L + 1) * unsafe_binomial(la + lc + L + 1, 2 * L + 1) *
-                                          unsafe_binomial(2 * L, L + la - lc);
-                        const double tc = tb * _tc * t3 / d3;
-                        const int ldmin = std::max(std::abs(l2 - lc), std::abs(l - lb));
-                        const int ldmax = std::min(ed, std::min(l2 + lc, l + lb));
-                        for (int ld = ldmin; ld <= ldmax; ld += 2)
+                        // `f[l3 - l3min]`, `l3min = max(|l1 - l2|, |m1 + m2|)`
+                        wigner.f3j_range(2 * l1, 2 * l2, 2 * m1, 2 * m2, f.data());
+                        const int l3min = std::max(std::abs(l1 - l2), std::abs(m1 + m2));
+                        for (int l3 = l3min + (l1 + l2 + l3min) % 2; l3 <= l1 + l2; l3 += 2)
                         {
-                            const int nd = (ed - ld) / 2;
-                            const int nld = nd + ld;
-                            const double _td = quick_pow(2, ld) * (2 * ld + 1) * unsafe_binomial(ed + 1, nd) /
-                                               unsafe_binomial(2 * nld + 1, nld);
-                            const int g2 = (lc + ld + l2) / 2;
-                            const double t2 = unsafe_binomial(g2, l2) * unsafe_binomial(l2, g2 - lc);
-                            const int g4 = (lb + ld + l) / 2;
-                            const double t4 = unsafe_binomial(g4, l) * unsafe_binomial(l, g4 - lb);
-                            const double d4 = (2 * l + 1) * unsafe_binomial(lb + ld + l + 1, 2 * l + 1) *
-                                              unsafe_binomial(2 * l, l + lb - ld);
-                            const double td = tc * _td * t2 * t4 / d4;
-                            const double m9j = _m9j(la, lb, l1, lc, ld, l2, L, l, lambda);
-                            sum += iphase(ld) * td * m9j;
+                            _l3.push_back(l3);
+                            _values.push_back(row[(l3 - std::abs(l1 - l2)) / 2] * f[l3 - l3min]);
                         }
+                        _offsets.push_back(_values.size());
                     }
                 }
             }
         }
-        return pre * sum;
     }
 
-    double dfunc(int dj, int dm1, int dm2, double beta) const
+    int lmax() const { return _lmax; }
+    // number of stored coefficients
+    std::size_t size() const { return _values.size(); }
+    std::size_t memory() const
     {
-        if (!(check_jm(dj, dm1) && check_jm(dj, dm2)))
-            return 0.;
-        const int jm1 = (dj - dm1) / 2;
-        const int jp1 = (dj + dm1) / 2;
-        const int jm2 = (dj - dm2) / 2;
-        const int mm = (dm1 + dm2) / 2;
-        const double c = std::cos(beta / 2);
-        const double s = std::sin(beta / 2);
-        const int kmin = std::max(0, -mm);
-        const int kmax = std::min(jm1, jm2);
-        double sum = 0.;
-        for (int k = kmin; k <= kmax; ++k)
-        {
-            sum = -sum + unsafe_binomial(jm1, k) * unsafe_binomial(jp1, mm + k) * quick_pow(c, mm + 2 * k) *
-                             quick_pow(s, jm1 + jm2 - 2 * k);
-        }
-        sum = iphase(jm2 + kmax) * sum;
-        sum = sum * std::sqrt(unsafe_binomial(dj, jm1) / unsafe_binomial(dj, jm2));
-        return sum;
+        return _values.size() * (sizeof(result_type) + sizeof(int)) + _offsets.size() * sizeof(std::size_t);
     }
 
-    void reserve(int num, std::string type, int rank)
+    // `l(l+1)+m`, the index of `Y_{lm}`
+    static int lm(int l, int m) { return l * (l + 1) + m; }
+    // no range check, `l1, l2 <= lmax()` is required, the entries of the row are `begin(..) <= i < end(..)`
+    std::size_t row(int l1, int m1, int l2, int m2) const
     {
-        if (type == "Jmax")
+        return std::size_t(lm(l1, m1)) * ((_lmax + 1) * (_lmax + 1)) + lm(l2, m2);
+    }
+    std::size_t begin(int l1, int m1, int l2, int m2) const { return _offsets[row(l1, m1, l2, m2)]; }
+    std::size_t end(int l1, int m1, int l2, int m2) const { return _offsets[row(l1, m1, l2, m2) + 1]; }
+    // the CSR arrays, `offsets()` has `(lmax+1)^4 + 1` entries
+    const std::size_t *offsets() const { return _offsets.data(); }
+    const int *l3() const { return _l3.data(); }
+    const result_type *values() const { return _values.data(); }
+
+    // `Gaunt(l1, l2, l3, m1, m2, m3)` from the table, 0 if it is not allowed or `l1, l2 > lmax()`
+    result_type operator()(int l1, int l2, int l3, int m1, int m2, int m3) const
+    {
+        if (unsigned(l1) > unsigned(_lmax) || unsigned(l2) > unsigned(_lmax) || std::abs(m1) > l1 ||
+            std::abs(m2) > l2 || m1 + m2 + m3 != 0)
+            return 0;
+        const std::size_t b = begin(l1, m1, l2, m2), e = end(l1, m1, l2, m2);
+        if (b == e || l3 < _l3[b] || l3 > _l3[e - 1] || (l3 - _l3[b]) % 2 != 0)
+            return 0;
+        return _values[b + (l3 - _l3[b]) / 2];
+    }
+
+    // The coefficients of the product `f g = sum c_{LM} Y_{LM}` of `f = sum a_{lm} Y_{lm}` and `g = sum b_{lm} Y_{lm}`,
+    // `a, b` have `(lmax+1)^2` and `c` has `(2lmax+1)^2` numbers at `lm(l, m)`. It streams the table once,
+    // `c_{LM} = sum (-1)^M Gaunt(l1, l2, L, m1, m2, -M) a_{l1m1} b_{l2m2}`.
+    void product(const result_type *a, const result_type *b, result_type *c) const
+    {
+        std::fill(c, c + (2 * _lmax + 1) * (2 * _lmax + 1), result_type(0));
+        const int n = (_lmax + 1) * (_lmax + 1);
+        const std::size_t *offsets = _offsets.data();
+        for (int l1 = 0; l1 <= _lmax; ++l1)
         {
-            switch (rank)
+            for (int m1 = -l1; m1 <= l1; ++m1, offsets += n)
             {
-                case 3: fill_binomial_data(3 * num + 1); break;
-                case 6: fill_binomial_data(4 * num + 1); break;
-                case 9: fill_binomial_data(5 * num + 1); break;
-                default:
+                const result_type x = a[lm(l1, m1)];
+                std::size_t i = offsets[0];
+                for (int l2 = 0; l2 <= _lmax; ++l2)
                 {
-                    std::cerr << "Error: rank must be 3, 6, or 9" << std::endl;
-                    std::exit(-1);
+                    for (int m2 = -l2; m2 <= l2; ++m2)
+                    {
+                        const int M = m1 + m2;
+                        const std::size_t end = offsets[lm(l2, m2) + 1];
+                        const result_type y = (M % 2 == 0 ? x : -x) * b[lm(l2, m2)];
+                        for (; i < end; ++i)
+                            c[lm(_l3[i], M)] += _values[i] * y;
+                    }
                 }
             }
         }
-        else if (type == "2bjmax")
+    }
+
+  private:
+    int _lmax;
+    std::vector<std::size_t> _offsets;
+    std::vector<int> _l3;
+    std::vector<result_type> _values;
+};
+
+// All 6j symbols `{ja jb J; jc jd J'}` of the `"2bjmax"` assumption, the single particle `ja, jb, jc, jd <= djmax / 2`
+// with the parity of `djmax` (half integers for odd `djmax`) and the two body `J, J'`, the order of a Pandya transform.
+// The other arguments are determined by the triangle conditions, so the table holds a dense block of `J, J'` for each
+// `ja, jb, jc, jd`, `max(|ja - jb|, |jc - jd|) <= J <= min(ja + jb, jc + jd)` and the same for `J'` with `jb` and `jd`
+// swapped, and a lookup reads the block offset and then the value. The columns of `J` are filled by `f6j_range`,
+// other symbols fall back to `f6j`.
+template <typename T>
+class Wigner6jTable
+{
+  public:
+    using value_type = T;
+    using result_type = typename _wigner_result<T>::type;
+
+    explicit Wigner6jTable(int djmax, TablePolicy policy = TablePolicy{}) : _djmax(djmax), _n(djmax / 2 + 1)
+    {
+        if (djmax < 0)
         {
-            switch (rank)
-            {
-                case 3: fill_binomial_data(2 * num + 1); break;
-                case 6: fill_binomial_data(3 * num + 1); break;
-                case 9: fill_binomial_data(4 * num + 1); break;
-                default:
-                {
-                    std::cerr << "Error: rank must be 3, 6, or 9" << std::endl;
-                    std::exit(-1);
-                }
-            }
+            std::cerr << "Error: Wigner6jTable needs djmax >= 0" << std::endl;
+            std::exit(-1);
         }
-        else if (type == "Moshinsky")
+        _offsets.reset(new std::size_t[std::size_t(_n) * _n * _n * _n + 1]);
+        _values = _allocate_table<result_type>(size(djmax), policy);
+        _wigner.set_reserve_mode(ReserveMode::grow);
+        const int p = djmax & 1;
+        std::vector<result_type> column(djmax + 1);
+        std::size_t i = 0, k = 0;
+        for (int dja = p; dja <= djmax; dja += 2)
+            for (int djb = p; djb <= djmax; djb += 2)
+                for (int djc = p; djc <= djmax; djc += 2)
+                    for (int djd = p; djd <= djmax; djd += 2)
+                    {
+                        _offsets[k++] = i;
+                        const _block b(dja, djb, djc, djd);
+                        if (b.hi < b.lo || b.hip < b.lop)
+                            continue;
+                        // the column of `J` is the `f6j_range` of `{J ja jb; J' jc jd}`
+                        const int width = (b.hip - b.lop) / 2 + 1;
+                        for (int dJp = b.lop; dJp <= b.hip; dJp += 2)
+                        {
+                            const int count = _wigner.f6j_range(dja, djb, dJp, djc, djd, column.data());
+                            for (int r = 0; r < count; ++r)
+                                _values[i + std::size_t(r) * width + (dJp - b.lop) / 2] = column[r];
+                        }
+                        i += b.size();
+                    }
+        _offsets[k] = i;
+    }
+    Wigner6jTable(const Wigner6jTable &) = delete;
+    Wigner6jTable &operator=(const Wigner6jTable &) = delete;
+
+    int djmax() const { return _djmax; }
+
+    // number of stored symbols for `djmax`, roughly `djmax^6 / 200`
+    static std::size_t size(int djmax)
+    {
+        std::size_t n = 0;
+        for (int dja = djmax & 1; dja <= djmax; dja += 2)
+            for (int djb = djmax & 1; djb <= djmax; djb += 2)
+                for (int djc = djmax & 1; djc <= djmax; djc += 2)
+                    for (int djd = djmax & 1; djd <= djmax; djd += 2)
+                        n += _block(dja, djb, djc, djd).size();
+        return n;
+    }
+    // bytes that the table of `djmax` needs, for example 0.7MB for `djmax = 15` and 25MB for `djmax = 29` with double
+    static std::size_t memory(int djmax)
+    {
+        const std::size_t n = djmax / 2 + 1;
+        return size(djmax) * sizeof(result_type) + (n * n * n * n + 1) * sizeof(std::size_t);
+    }
+    std::size_t size() const { return _offsets[std::size_t(_n) * _n * _n * _n]; }
+    std::size_t memory() const { return memory(_djmax); }
+
+    // `{ja jb J; jc jd J'}`, from the table if `ja, jb, jc, jd` are in it, 0 if it is not allowed
+    result_type f6j(int dja, int djb, int dJ, int djc, int djd, int dJp) const
+    {
+        // the checks are combined without `&&` and `||`, each of their branches is missed often in the loops over `J`
+        const unsigned djmax = _djmax;
+        if ((unsigned(dja) > djmax) | (unsigned(djb) > djmax) | (unsigned(djc) > djmax) | (unsigned(djd) > djmax) |
+            (((dja ^ _djmax) | (djb ^ _djmax) | (djc ^ _djmax) | (djd ^ _djmax)) & 1))
+            return _wigner.f6j(dja, djb, dJ, djc, djd, dJp);
+        const _block b(dja, djb, djc, djd);
+        const int w = b.hi - b.lo, wp = b.hip - b.lop;
+        const unsigned x = dJ - b.lo, y = dJp - b.lop;
+        if ((w < 0) | (wp < 0) | (x > unsigned(w)) | (y > unsigned(wp)) | ((x | y) & 1))
+            return 0;
+        const std::size_t block = ((std::size_t(dja >> 1) * _n + (djb >> 1)) * _n + (djc >> 1)) * _n + (djd >> 1);
+        return _values[_offsets[block] + x / 2 * (wp / 2 + 1) + y / 2];
+    }
+
+  private:
+    // the ranges of `J` and `J'`, empty if `hi < lo`
+    struct _block
+    {
+        int lo, hi, lop, hip;
+
+        _block(int dja, int djb, int djc, int djd)
+            : lo(std::max(std::abs(dja - djb), std::abs(djc - djd))), hi(std::min(dja + djb, djc + djd)),
+              lop(std::max(std::abs(dja - djd), std::abs(djc - djb))), hip(std::min(dja + djd, djc + djb))
         {
-            fill_binomial_data(6 * num + 1);
         }
-        else if (type == "nmax")
+        std::size_t size() const
         {
-            fill_binomial_data(num);
+            return hi < lo || hip < lop ? 0 : std::size_t(hi - lo + 2) / 2 * ((hip - lop) / 2 + 1);
         }
-        else
+    };
+
+    int _djmax;
+    int _n;
+    std::unique_ptr<std::size_t[]> _offsets;
+    _table_ptr<result_type> _values;
+    BasicWignerSymbols<T> _wigner;
+};
+
+// A memoising cache of the 6j symbols shared by threads. The 144 symmetries of `{j1 j2 j3; j4 j5 j6}` permute its four
+// triad sums `a` and its three sums `b` of the four arguments of two columns, and the Racah formula depends only on
+// these sums (the triangle factors are the `b - a`), so the sorted sums are the canonical form. In `j` units they are
+// packed into a 62 bit key, `a1 <= .. <= a4 < 1024` in 10 bits and the two smaller `b` in 11 bits, larger symbols skip
+// the cache. The keys live in a lock-free open addressing table of fixed capacity: a slot is claimed by a CAS on its
+// key, published by a release store after its value and never overwritten, a value that finds no free slot within
+// `max_probe` steps is not stored. In front of it each thread keeps a small direct mapped cache of its lookups.
+template <typename T>
+class Wigner6jCache
+{
+  public:
+    using value_type = T;
+    using result_type = typename _wigner_result<T>::type;
+
+    // The counters since the construction or `reset_stats`, summed over the threads. Each thread counts in its own
+    // stripe without atomic read-modify-write, with more than 64 threads a few counts may be lost.
+    // The zero symbols by the triangle conditions return before they are counted.
+    struct Stats
+    {
+        std::uint64_t front_hits = 0;
+        std::uint64_t shared_hits = 0;
+        // computed by the engine, including the symbols too large for the key
+        std::uint64_t misses = 0;
+        // every `sample_period`-th lookup of each thread is timed after its key, including the two clock reads
+        std::uint64_t sampled = 0;
+        std::uint64_t sampled_ns = 0;
+
+        std::uint64_t lookups() const { return front_hits + shared_hits + misses; }
+        double hit_rate() const { return lookups() == 0 ? 0 : double(front_hits + shared_hits) / lookups(); }
+        double latency_ns() const { return sampled == 0 ? 0 : double(sampled_ns) / sampled; }
+    };
+
+    static constexpr std::uint64_t invalid_key = ~std::uint64_t(0);
+    static constexpr std::uint64_t large_key = invalid_key - 1;
+    static constexpr int front_size = 256;
+    static constexpr int max_probe = 32;
+    static constexpr int sample_period = 64;
+
+    // `capacity` is rounded up to a power of 2, for example 16MB for the default 2^20 slots with double
+    explicit Wigner6jCache(std::size_t capacity = std::size_t(1) << 20) : _id(_next_id.fetch_add(1) + 1)
+    {
+        std::size_t n = 16;
+        while (n < capacity)
+            n *= 2;
+        _mask = n - 1;
+        _slots.reset(new _slot[n]);
+        _stripes.reset(new _stripe[_stripe_count]);
+        _wigner.set_reserve_mode(ReserveMode::grow);
+    }
+    Wigner6jCache(const Wigner6jCache &) = delete;
+    Wigner6jCache &operator=(const Wigner6jCache &) = delete;
+
+    std::size_t capacity() const { return _mask + 1; }
+    // number of stored symbols
+    std::size_t size() const { return _size.load(std::memory_order_relaxed); }
+    std::size_t memory() const { return capacity() * sizeof(_slot) + _stripe_count * sizeof(_stripe); }
+
+    // The canonical key, equal for the 144 symmetric forms, `invalid_key` if the symbol is zero by the triangle
+    // conditions and `large_key` if a triad sum is larger than 2046.
+    static std::uint64_t key(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6)
+    {
+        if ((dj1 | dj2 | dj3 | dj4 | dj5 | dj6) < 0)
+            return invalid_key;
+        int a[4] = {dj1 + dj2 + dj3, dj1 + dj5 + dj6, dj4 + dj2 + dj6, dj4 + dj5 + dj3};
+        int b[3] = {dj1 + dj2 + dj4 + dj5, dj1 + dj3 + dj4 + dj6, dj2 + dj3 + dj5 + dj6};
+        // the triangle conditions are `a <= b` for all pairs, checked before the sorting for the many zero symbols
+        if (((a[0] | a[1] | a[2] | a[3]) & 1) ||
+            std::max(std::max(a[0], a[1]), std::max(a[2], a[3])) > std::min(std::min(b[0], b[1]), b[2]))
+            return invalid_key;
+        _sort2(a[0], a[1]), _sort2(a[2], a[3]), _sort2(a[0], a[2]), _sort2(a[1], a[3]), _sort2(a[1], a[2]);
+        _sort2(b[0], b[1]), _sort2(b[1], b[2]), _sort2(b[0], b[1]);
+        if (a[3] > 2046)
+            return large_key;
+        return std::uint64_t(a[0] / 2) | std::uint64_t(a[1] / 2) << 10 | std::uint64_t(a[2] / 2) << 20 |
+               std::uint64_t(a[3] / 2) << 30 | std::uint64_t(b[0] / 2) << 40 | std::uint64_t(b[1] / 2) << 51;
+    }
+
+    result_type f6j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6) const
+    {
+        const std::uint64_t key = this->key(dj1, dj2, dj3, dj4, dj5, dj6);
+        if (key == invalid_key)
+            return 0;
+        _front &front = _local();
+        _stripe &stripe = _stripes[front.stripe];
+        if (--front.countdown != 0)
+            return _lookup(front, stripe, key, dj1, dj2, dj3, dj4, dj5, dj6);
+        front.countdown = sample_period;
+        const auto t1 = std::chrono::steady_clock::now();
+        const result_type x = _lookup(front, stripe, key, dj1, dj2, dj3, dj4, dj5, dj6);
+        const auto t2 = std::chrono::steady_clock::now();
+        _bump(stripe.sampled);
+        _bump(stripe.sampled_ns, std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+        return x;
+    }
+
+    Stats stats() const
+    {
+        Stats s;
+        for (int i = 0; i < _stripe_count; ++i)
         {
-            std::cerr << "Error: type must be Jmax, 2bjmax, Moshinsky or nmax" << std::endl;
-            std::exit(-1);
+            const _stripe &c = _stripes[i];
+            s.front_hits += c.front_hits.load(std::memory_order_relaxed);
+            s.shared_hits += c.shared_hits.load(std::memory_order_relaxed);
+            s.misses += c.misses.load(std::memory_order_relaxed);
+            s.sampled += c.sampled.load(std::memory_order_relaxed);
+            s.sampled_ns += c.sampled_ns.load(std::memory_order_relaxed);
         }
+        return s;
+    }
+    // only while no thread looks up, otherwise some counts may survive
+    void reset_stats()
+    {
+        for (int i = 0; i < _stripe_count; ++i)
+            _stripes[i].clear();
     }
 
   private:
-    std::vector<double> _binomial_data;
-    int _nmax;
-    static std::size_t _binomial_data_size(int n)
+    static constexpr std::uint64_t _key_mask = (std::uint64_t(1) << 62) - 1;
+    static constexpr std::uint64_t _busy = std::uint64_t(1) << 62;
+    static constexpr std::uint64_t _ready = std::uint64_t(1) << 63;
+    static constexpr int _stripe_count = 64;
+
+    struct _slot
+    {
+        // 0 if empty, else the key with `_busy` while the value is written, then with `_ready`
+        std::atomic<std::uint64_t> key{0};
+        result_type value{};
+    };
+    struct alignas(64) _stripe
+    {
+        std::atomic<std::uint64_t> front_hits{0}, shared_hits{0}, misses{0}, sampled{0}, sampled_ns{0};
+
+        void clear()
+        {
+            for (auto *c : {&front_hits, &shared_hits, &misses, &sampled, &sampled_ns})
+                c->store(0, std::memory_order_relaxed);
+        }
+    };
+    // the front cache of one thread for all caches of type `T`, an entry matches only the `_id` of its cache
+    struct _front
     {
-        std::size_t x = n / 2 + 1;
-        return x * (x + isodd(n));
+        struct
+        {
+            std::uint64_t id = 0;
+            std::uint64_t key = 0;
+            result_type value{};
+        } entries[front_size];
+        int stripe = _next_stripe.fetch_add(1, std::memory_order_relaxed) % _stripe_count;
+        int countdown = sample_period;
+    };
+
+    static _front &_local()
+    {
+        thread_local _front front;
+        return front;
     }
-    static std::size_t _binomial_index(int n, int k)
+    // only the owner thread of a stripe writes it, so a relaxed load and store is enough
+    static void _bump(std::atomic<std::uint64_t> &c, std::uint64_t n = 1)
     {
-        std::size_t x = n / 2 + 1;
-        return x * (x - iseven(n)) + k;
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
     }
-    void fill_binomial_data(int nmax)
+    // in arithmetic, the compiler turns `std::min` into branches here, which the random arguments miss
+    static void _sort2(int &x, int &y)
     {
-        if (nmax <= _nmax)
-            return;
-        std::vector<double> old_data = _binomial_data;
-        std::size_t reserve_size = _binomial_data_size(nmax);
-        if (reserve_size > std::numeric_limits<int>::max())
+        const int d = y - x, lo = x + (d & (d >> 31));
+        y = x + y - lo, x = lo;
+    }
+    // the splitmix64 finalizer, the table uses the low bits and the front caches the high bits
+    static std::uint64_t _hash(std::uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+        return x ^ (x >> 31);
+    }
+
+    result_type _lookup(_front &front, _stripe &stripe, std::uint64_t key, int dj1, int dj2, int dj3, int dj4, int dj5,
+                        int dj6) const
+    {
+        if (key == large_key)
         {
-            std::cerr << "Error: nmax too large" << std::endl;
-            std::exit(-1);
+            _bump(stripe.misses);
+            return _wigner.f6j(dj1, dj2, dj3, dj4, dj5, dj6);
         }
-        _binomial_data.resize(reserve_size);
-        std::copy(std::begin(old_data), std::end(old_data), _binomial_data.begin());
-        for (int n = _nmax + 1; n <= nmax; ++n)
+        const std::uint64_t h = _hash(key);
+        auto &entry = front.entries[h >> (64 - 8)];
+        static_assert(front_size == 256, "the front index takes the highest 8 bits of the hash");
+        if (entry.key == key && entry.id == _id)
         {
-            for (int k = 0; k <= n / 2; ++k)
+            _bump(stripe.front_hits);
+            return entry.value;
+        }
+        entry.id = _id;
+        entry.key = key;
+        entry.value = _shared(stripe, key, h);
+        return entry.value;
+    }
+
+    result_type _shared(_stripe &stripe, std::uint64_t key, std::uint64_t h) const
+    {
+        std::size_t i = h & _mask;
+        int probe = 0;
+        for (; probe < max_probe; ++probe, i = (i + 1) & _mask)
+        {
+            const std::uint64_t k = _slots[i].key.load(std::memory_order_acquire);
+            if (k == (key | _ready))
+            {
+                _bump(stripe.shared_hits);
+                return _slots[i].value;
+            }
+            if (k == 0)
+                break;
+        }
+        _bump(stripe.misses);
+        // the value of the canonical form, so it does not depend on which form came first
+        const int a1 = key & 1023, a2 = (key >> 10) & 1023, a3 = (key >> 20) & 1023, a4 = (key >> 30) & 1023;
+        const int b1 = (key >> 40) & 2047, b2 = (key >> 51) & 2047, b3 = a1 + a2 + a3 + a4 - b1 - b2;
+        const result_type x =
+            _wigner.f6j(a1 + a2 - b3, a1 + a3 - b2, a1 + a4 - b1, a3 + a4 - b3, a2 + a4 - b2, a2 + a3 - b1);
+        for (; probe < max_probe; ++probe, i = (i + 1) & _mask)
+        {
+            std::uint64_t k = 0;
+            if (_slots[i].key.compare_exchange_strong(k, key | _busy, std::memory_order_relaxed))
             {
-                _binomial_data[_binomial_index(n, k)] = binomial(n - 1, k) + binomial(n - 1, k - 1);
+                _slots[i].value = x;
+                _slots[i].key.store(key | _ready, std::memory_order_release);
+                _size.fetch_add(1, std::memory_order_relaxed);
+                break;
             }
-            ++_nmax;
+            // another thread stores the same symbol
+            if ((k & _key_mask) == key)
+                break;
         }
-        _nmax = nmax;
+        return x;
     }
+
+    static inline std::atomic<std::uint64_t> _next_id{0};
+    static inline std::atomic<int> _next_stripe{0};
+
+    std::uint64_t _id;
+    std::size_t _mask;
+    std::unique_ptr<_slot[]> _slots;
+    std::unique_ptr<_stripe[]> _stripes;
+    mutable std::atomic<std::size_t> _size{0};
+    BasicWignerSymbols<T> _wigner;
 };
 
-inline WignerSymbols wigner;
+// one global engine for each type, the free functions below use `basic_wigner<T>`, for example
+// `wigner_6j<long double>(...)`, and `T` defaults to `double`
+template <typename T>
+inline BasicWignerSymbols<T> basic_wigner;
+
+inline WignerSymbols &wigner = basic_wigner<double>;
+
+template <typename T>
+using wigner_result_t = typename BasicWignerSymbols<T>::result_type;
+
+template <typename T = double>
+inline void wigner_init(int num, std::string type, int rank)
+{
+    basic_wigner<T>.reserve(num, type, rank);
+}
+
+template <typename T = double>
+inline void wigner_reserve_mode(ReserveMode mode)
+{
+    basic_wigner<T>.set_reserve_mode(mode);
+}
+
+// `false` makes `wigner_6j` and `wigner_9j` always sum the general formulas
+template <typename T = double>
+inline void wigner_closed_forms(bool on)
+{
+    basic_wigner<T>.set_closed_forms(on);
+}
 
-inline void wigner_init(int num, std::string type, int rank) { wigner.reserve(num, type, rank); }
+template <typename T = double>
+inline T fast_binomial(int n, int k)
+{
+    return basic_wigner<T>.binomial(n, k);
+}
 
-inline double fast_binomial(int n, int k) { return wigner.binomial(n, k); }
+// if three angular momentum can couple, one bitmap lookup after `wigner_init(djmax, "triad", 0)`
+template <typename T = double>
+inline bool wigner_triad(int dj1, int dj2, int dj3)
+{
+    return basic_wigner<T>.triad(dj1, dj2, dj3);
+}
 
 // CG coefficient for two spin-1/2
 inline double CGspin(int dm1, int dm2, int S)
@@ -740,36 +3440,233 @@ inline double CG3spin(int dm1, int dm2, int dm3, int S12, int dS)
     return values[dm1 > 0][dm2 > 0][dm3 > 0][(S12 + dS) / 2];
 }
 
-inline double CG(int dj1, int dj2, int dj3, int dm1, int dm2, int dm3)
+// `n!` and the square root for the compile time tables of small spins, where the factorials are exact
+constexpr double _constexpr_factorial(int n)
+{
+    double x = 1;
+    for (int i = 2; i <= n; ++i)
+        x *= i;
+    return x;
+}
+
+// Newton iteration from above, it decreases until it stops at the rounded root
+constexpr double _constexpr_sqrt(double x)
+{
+    if (x <= 0)
+        return 0;
+    double y = x > 1 ? x : 1;
+    while (true)
+    {
+        const double z = 0.5 * (y + x / y);
+        if (z >= y)
+            return y;
+        y = z;
+    }
+}
+
+// `CG(dj1, dj2, dJ, dm1, dm2, dm1 + dm2)` by the Racah formula, the square of the prefactor and of the sum are
+// multiplied first, then one root is taken
+constexpr double _constexpr_CG(int dj1, int dj2, int dJ, int dm1, int dm2)
+{
+    const int dM = dm1 + dm2;
+    const auto abs = [](int x) { return x < 0 ? -x : x; };
+    if (((dj1 + dm1) | (dj2 + dm2) | (dj1 + dj2 + dJ)) & 1)
+        return 0;
+    if (abs(dm1) > dj1 || abs(dm2) > dj2 || abs(dM) > dJ || dJ > dj1 + dj2 || dJ < abs(dj1 - dj2))
+        return 0;
+    const int a = (dj1 + dj2 - dJ) / 2, b = (dj1 - dj2 + dJ) / 2, c = (dj2 - dj1 + dJ) / 2;
+    const int j1p = (dj1 + dm1) / 2, j1m = (dj1 - dm1) / 2, j2p = (dj2 + dm2) / 2, j2m = (dj2 - dm2) / 2;
+    const int Jp = (dJ + dM) / 2, Jm = (dJ - dM) / 2;
+    double sum = 0;
+    for (int k = 0; k <= a; ++k)
+    {
+        const int d1 = j1m - k, d2 = j2p - k, d3 = c - j2p + k, d4 = b - j1m + k;
+        if (d1 < 0 || d2 < 0 || d3 < 0 || d4 < 0)
+            continue;
+        const double term = 1 / (_constexpr_factorial(k) * _constexpr_factorial(a - k) * _constexpr_factorial(d1) *
+                                 _constexpr_factorial(d2) * _constexpr_factorial(d3) * _constexpr_factorial(d4));
+        sum += k % 2 == 0 ? term : -term;
+    }
+    const double pre = (dJ + 1) * _constexpr_factorial(a) * _constexpr_factorial(b) * _constexpr_factorial(c) /
+                       _constexpr_factorial(a + b + c + 1) * _constexpr_factorial(j1p) * _constexpr_factorial(j1m) *
+                       _constexpr_factorial(j2p) * _constexpr_factorial(j2m) * _constexpr_factorial(Jp) *
+                       _constexpr_factorial(Jm);
+    const double x = _constexpr_sqrt(pre * sum * sum);
+    return sum < 0 ? -x : x;
+}
+
+// `values[((dj1 + dm1) / 2 * (dj2 + 1) + (dj2 + dm2) / 2) * nJ + (dJ - |dj1 - dj2|) / 2]` of `CGfixed`
+template <int dj1, int dj2>
+struct _CG_fixed_table
+{
+    static_assert(0 <= dj1 && dj1 <= 8 && 0 <= dj2 && dj2 <= 8, "the spins of the compile time tables are dj <= 8");
+    static constexpr int dJmin = dj1 > dj2 ? dj1 - dj2 : dj2 - dj1;
+    static constexpr int nJ = (dj1 + dj2 - dJmin) / 2 + 1;
+    static constexpr std::array<double, (dj1 + 1) * (dj2 + 1) * nJ> make()
+    {
+        std::array<double, (dj1 + 1) * (dj2 + 1) * nJ> values{};
+        for (int i1 = 0; i1 <= dj1; ++i1)
+            for (int i2 = 0; i2 <= dj2; ++i2)
+                for (int iJ = 0; iJ < nJ; ++iJ)
+                    values[(i1 * (dj2 + 1) + i2) * nJ + iJ] =
+                        _constexpr_CG(dj1, dj2, dJmin + 2 * iJ, 2 * i1 - dj1, 2 * i2 - dj2);
+        return values;
+    }
+    static constexpr std::array<double, (dj1 + 1) * (dj2 + 1) * nJ> values = make();
+};
+
+// `values[((i123 * nJ12 + iJ12) * nJ + iJ]` of `CG3fixed`, `i123` is the index of the three projections like in
+// `_CG_fixed_table`, `iJ12 = (dJ12 - |dj1 - dj2|) / 2` and `iJ = dJ / 2` rounded down
+template <int dj1, int dj2, int dj3>
+struct _CG3_fixed_table
+{
+    static_assert(0 <= dj3 && dj3 <= 8, "the spins of the compile time tables are dj <= 8");
+    using pair = _CG_fixed_table<dj1, dj2>;
+    static constexpr int nJ12 = pair::nJ;
+    static constexpr int nJ = (dj1 + dj2 + dj3) / 2 + 1;
+    static constexpr int size = (dj1 + 1) * (dj2 + 1) * (dj3 + 1) * nJ12 * nJ;
+    static constexpr std::array<double, size> make()
+    {
+        std::array<double, size> values{};
+        for (int i1 = 0; i1 <= dj1; ++i1)
+            for (int i2 = 0; i2 <= dj2; ++i2)
+                for (int i3 = 0; i3 <= dj3; ++i3)
+                    for (int iJ12 = 0; iJ12 < nJ12; ++iJ12)
+                        for (int iJ = 0; iJ < nJ; ++iJ)
+                        {
+                            const int dm1 = 2 * i1 - dj1, dm2 = 2 * i2 - dj2, dm3 = 2 * i3 - dj3;
+                            const int dJ12 = pair::dJmin + 2 * iJ12, dJ = 2 * iJ + (dj1 + dj2 + dj3) % 2;
+                            values[(((i1 * (dj2 + 1) + i2) * (dj3 + 1) + i3) * nJ12 + iJ12) * nJ + iJ] =
+                                pair::values[(i1 * (dj2 + 1) + i2) * nJ12 + iJ12] *
+                                _constexpr_CG(dJ12, dj3, dJ, dm1 + dm2, dm3);
+                        }
+        return values;
+    }
+    static constexpr std::array<double, size> values = make();
+};
+
+// `CG(dj1, dj2, dJ, dm1, dm2, dm1 + dm2)` of two fixed small spins, for example `CGfixed<2, 3>` for a spin 1 and a
+// spin 3/2. The table of each pair of spins is computed at compile time, so a call is a few range checks and one
+// lookup, and it can be evaluated at compile time itself. `CGfixed<1, 1>(dm1, dm2, 2 * S)` is `CGspin(dm1, dm2, S)`.
+template <int dj1, int dj2>
+constexpr double CGfixed(int dm1, int dm2, int dJ)
+{
+    using table = _CG_fixed_table<dj1, dj2>;
+    const int i1 = dj1 + dm1, i2 = dj2 + dm2, iJ = dJ - table::dJmin;
+    // the unsigned comparisons also reject negative values
+    if (unsigned(i1) > unsigned(2 * dj1) || unsigned(i2) > unsigned(2 * dj2) || unsigned(iJ) > 2u * (table::nJ - 1))
+        return 0;
+    if ((i1 | i2 | iJ) & 1)
+        return 0;
+    return table::values[((i1 / 2) * (dj2 + 1) + i2 / 2) * table::nJ + iJ / 2];
+}
+
+// `<J12 M12|j1 m1; j2 m2><J M|J12 M12; j3 m3>` of three fixed small spins, like `CG3spin` with doubled `dJ12`,
+// `CG3fixed<1, 1, 1>(dm1, dm2, dm3, 2 * S12, dS)` is `CG3spin(dm1, dm2, dm3, S12, dS)`
+template <int dj1, int dj2, int dj3>
+constexpr double CG3fixed(int dm1, int dm2, int dm3, int dJ12, int dJ)
+{
+    using table = _CG3_fixed_table<dj1, dj2, dj3>;
+    const int i1 = dj1 + dm1, i2 = dj2 + dm2, i3 = dj3 + dm3, iJ12 = dJ12 - table::pair::dJmin;
+    const int iJ = dJ - (dj1 + dj2 + dj3) % 2;
+    if (unsigned(i1) > unsigned(2 * dj1) || unsigned(i2) > unsigned(2 * dj2) || unsigned(i3) > unsigned(2 * dj3) ||
+        unsigned(iJ12) > 2u * (table::nJ12 - 1) || unsigned(iJ) > 2u * (table::nJ - 1))
+        return 0;
+    if ((i1 | i2 | i3 | iJ12 | iJ) & 1)
+        return 0;
+    const int i = ((i1 / 2 * (dj2 + 1) + i2 / 2) * (dj3 + 1) + i3 / 2) * table::nJ12 + iJ12 / 2;
+    return table::values[i * table::nJ + iJ / 2];
+}
+
+template <typename T = double>
+inline wigner_result_t<T> CG(int dj1, int dj2, int dj3, int dm1, int dm2, int dm3)
+{
+    return basic_wigner<T>.CG(dj1, dj2, dj3, dm1, dm2, dm3);
+}
+
+// batch version, see `BasicWignerSymbols::CG`
+template <typename T = double>
+inline void CG(std::size_t n, const int *dj1, const int *dj2, const int *dj3, const int *dm1, const int *dm2,
+               const int *dm3, wigner_result_t<T> *out)
+{
+    basic_wigner<T>.CG(n, dj1, dj2, dj3, dm1, dm2, dm3, out);
+}
+
+// all `m1, m2` of one triad, see `BasicWignerSymbols::CG_block`
+template <typename T = double>
+inline void CG_block(int dj1, int dj2, int dj3, wigner_result_t<T> *out)
+{
+    basic_wigner<T>.CG_block(dj1, dj2, dj3, out);
+}
+
+template <typename T = double>
+inline wigner_result_t<T> CG0(int j1, int j2, int j3)
 {
-    return wigner.CG(dj1, dj2, dj3, dm1, dm2, dm3);
+    return basic_wigner<T>.CG0(j1, j2, j3);
 }
 
-inline double CG0(int j1, int j2, int j3) { return wigner.CG0(j1, j2, j3); }
+template <typename T = double>
+inline int CG0_range(int j1, int j2, wigner_result_t<T> *out)
+{
+    return basic_wigner<T>.CG0_range(j1, j2, out);
+}
+
+template <typename T = double>
+inline wigner_result_t<T> wigner_3j(int dj1, int dj2, int dj3, int dm1, int dm2, int dm3)
+{
+    return basic_wigner<T>.f3j(dj1, dj2, dj3, dm1, dm2, dm3);
+}
+
+template <typename T = double>
+inline void wigner_3j(std::size_t n, const int *dj1, const int *dj2, const int *dj3, const int *dm1, const int *dm2,
+                      const int *dm3, wigner_result_t<T> *out)
+{
+    basic_wigner<T>.f3j(n, dj1, dj2, dj3, dm1, dm2, dm3, out);
+}
 
-inline double wigner_3j(int dj1, int dj2, int dj3, int dm1, int dm2, int dm3)
+// all `dj3` of the 3j symbols, see `BasicWignerSymbols::f3j_range`
+template <typename T = double>
+inline int wigner_3j_range(int dj1, int dj2, int dm1, int dm2, wigner_result_t<T> *out)
 {
-    return wigner.f3j(dj1, dj2, dj3, dm1, dm2, dm3);
+    return basic_wigner<T>.f3j_range(dj1, dj2, dm1, dm2, out);
 }
 
-inline double wigner_6j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6)
+// Gaunt coefficient, see `BasicWignerSymbols::Gaunt`, the arguments are not doubled
+template <typename T = double>
+inline wigner_result_t<T> Gaunt(int l1, int l2, int l3, int m1, int m2, int m3)
 {
-    return wigner.f6j(dj1, dj2, dj3, dj4, dj5, dj6);
+    return basic_wigner<T>.Gaunt(l1, l2, l3, m1, m2, m3);
 }
 
-inline double Racah(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6)
+template <typename T = double>
+inline wigner_result_t<T> wigner_6j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6)
 {
-    return wigner.Racah(dj1, dj2, dj3, dj4, dj5, dj6);
+    return basic_wigner<T>.f6j(dj1, dj2, dj3, dj4, dj5, dj6);
 }
 
-inline double wigner_9j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6, int dj7, int dj8, int dj9)
+// all `dj1` of the 6j symbols, see `BasicWignerSymbols::f6j_range`
+template <typename T = double>
+inline int wigner_6j_range(int dj2, int dj3, int dj4, int dj5, int dj6, wigner_result_t<T> *out)
 {
-    return wigner.f9j(dj1, dj2, dj3, dj4, dj5, dj6, dj7, dj8, dj9);
+    return basic_wigner<T>.f6j_range(dj2, dj3, dj4, dj5, dj6, out);
 }
 
-inline double wigner_norm9j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6, int dj7, int dj8, int dj9)
+template <typename T = double>
+inline wigner_result_t<T> Racah(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6)
 {
-    return wigner.norm9j(dj1, dj2, dj3, dj4, dj5, dj6, dj7, dj8, dj9);
+    return basic_wigner<T>.Racah(dj1, dj2, dj3, dj4, dj5, dj6);
+}
+
+template <typename T = double>
+inline wigner_result_t<T> wigner_9j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6, int dj7, int dj8, int dj9)
+{
+    return basic_wigner<T>.f9j(dj1, dj2, dj3, dj4, dj5, dj6, dj7, dj8, dj9);
+}
+
+template <typename T = double>
+inline wigner_result_t<T> wigner_norm9j(int dj1, int dj2, int dj3, int dj4, int dj5, int dj6, int dj7, int dj8, int dj9)
+{
+    return basic_wigner<T>.norm9j(dj1, dj2, dj3, dj4, dj5, dj6, dj7, dj8, dj9);
 }
 
 inline double lsjj(int l1, int l2, int dj1, int dj2, int L, int S, int J)
@@ -777,11 +3674,17 @@ inline double lsjj(int l1, int l2, int dj1, int dj2, int L, int S, int J)
     return WignerSymbols::lsjj(l1, l2, dj1, dj2, L, S, J);
 }
 
-inline double dfunc(int dj, int dm1, int dm2, double beta) { return wigner.dfunc(dj, dm1, dm2, beta); }
+template <typename T = double>
+inline wigner_result_t<T> dfunc(int dj, int dm1, int dm2, double beta)
+{
+    return basic_wigner<T>.dfunc(dj, dm1, dm2, beta);
+}
 
-inline double Moshinsky(int N, int L, int n, int l, int n1, int l1, int n2, int l2, int lambda, double tan_beta = 1.0)
+template <typename T = double>
+inline wigner_result_t<T> Moshinsky(int N, int L, int n, int l, int n1, int l1, int n2, int l2, int lambda,
+                                    double tan_beta = 1.0)
 {
-    return wigner.Moshinsky(N, L, n, l, n1, l1, n2, l2, lambda, tan_beta);
+    return basic_wigner<T>.Moshinsky(N, L, n, l, n1, l1, n2, l2, lambda, tan_beta);
 }
 
 } // end namespace util
@@ -1,6 +1,10 @@
 #include "WignerSymbol.hpp"
 #include <chrono>
 #include <gsl/gsl_specfunc.h>
+#include <random>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
 
 using namespace util;
 
@@ -433,17 +437,1050 @@ void time_lsjj()
               << std::endl;
 }
 
+// the closed forms of `f6j` and `f9j` on the symbols of some operators between two-body states of orbits with
+// `j <= 15/2` and `l <= 7`, against the general sums, and how many symbols they apply to
+void time_closed_forms()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int djmax = 15;
+    WignerSymbols on, off;
+    on.reserve(4 * djmax, "Jmax", 9);
+    off.reserve(4 * djmax, "Jmax", 9);
+    off.set_closed_forms(false);
+    // `workload(w, hit)` sums the symbols of `w` and counts the nonzero ones and the ones `hit` says are closed forms
+    auto run = [&](const char *name, auto workload) {
+        long long count = 0, hits = 0;
+        auto t1 = timer_clock::now();
+        const double x = workload(on, count, hits);
+        auto t2 = timer_clock::now();
+        const double y = workload(off, count, hits);
+        auto t3 = timer_clock::now();
+        std::cout << name << ": " << count / 2 << " symbols, " << 100.0 * hits / count
+                  << "% closed forms, diff = " << x - y << std::endl;
+        std::cout << "closed forms time = " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()
+                  << " us, general time = " << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count()
+                  << " us" << std::endl;
+    };
+    auto small6 = [](int a, int b, int c, int d, int e, int f) {
+        return std::min(std::min(std::min(a, b), std::min(c, d)), std::min(e, f)) <= 2;
+    };
+    std::cout << "time closed forms" << std::endl;
+    // a one-body operator of rank `k <= 2` on the second particle, `{jb J ja; J' jc k}`
+    run("rank k <= 2 one-body operators", [&](const WignerSymbols &w, long long &count, long long &hits) {
+        double sum = 0;
+        for (int dja = 1; dja <= djmax; dja += 2)
+            for (int djb = 1; djb <= djmax; djb += 2)
+                for (int djc = 1; djc <= djmax; djc += 2)
+                    for (int dk = 0; dk <= 4; dk += 2)
+                        for (int dJ = std::abs(dja - djb); dJ <= dja + djb; dJ += 2)
+                            for (int dJp = std::abs(dja - djc); dJp <= dja + djc; dJp += 2)
+                            {
+                                const double x = w.f6j(djb, dJ, dja, dJp, djc, dk);
+                                sum += x;
+                                count += x != 0;
+                                hits += x != 0 && small6(djb, dJ, dja, dJp, djc, dk);
+                            }
+        return sum;
+    });
+    // the Pandya transform, `{ja jb J; jc jd J'}`, only orbits with `j <= 2` are closed forms
+    run("Pandya transform", [&](const WignerSymbols &w, long long &count, long long &hits) {
+        double sum = 0;
+        for (int dja = 1; dja <= djmax; dja += 2)
+            for (int djb = 1; djb <= djmax; djb += 2)
+                for (int djc = 1; djc <= djmax; djc += 2)
+                    for (int djd = 1; djd <= djmax; djd += 2)
+                        for (int dJ = std::abs(dja - djb); dJ <= dja + djb; dJ += 2)
+                            for (int dJp = std::abs(dja - djd); dJp <= dja + djd; dJp += 2)
+                            {
+                                const double x = w.f6j(dja, djb, dJ, djc, djd, dJp);
+                                sum += x;
+                                count += x != 0;
+                                hits += x != 0 && small6(dja, djb, dJ, djc, djd, dJp);
+                            }
+        return sum;
+    });
+    // the LS-jj transform of two particles, `{la 1/2 ja; lb 1/2 jb; L S J}`, all are closed forms
+    run("LS-jj transform", [&](const WignerSymbols &w, long long &count, long long &hits) {
+        double sum = 0;
+        for (int la = 0; la <= djmax / 2; ++la)
+            for (int lb = 0; lb <= djmax / 2; ++lb)
+                for (int dja = std::abs(2 * la - 1); dja <= 2 * la + 1; dja += 2)
+                    for (int djb = std::abs(2 * lb - 1); djb <= 2 * lb + 1; djb += 2)
+                        for (int L = std::abs(la - lb); L <= la + lb; ++L)
+                            for (int S = 0; S <= 1; ++S)
+                                for (int J = std::abs(L - S); J <= L + S; ++J)
+                                {
+                                    const double x = w.f9j(2 * la, 1, dja, 2 * lb, 1, djb, 2 * L, 2 * S, 2 * J);
+                                    sum += x;
+                                    count += x != 0;
+                                    hits += x != 0;
+                                }
+        return sum;
+    });
+    // a two-body operator `[O^k1 O^k2]^k` with `k1, k2, k <= 2`, `{ja jb J; jc jd J'; k1 k2 k}`, the ones with a 0 rank
+    // are closed forms
+    run("two-body tensor operators", [&](const WignerSymbols &w, long long &count, long long &hits) {
+        double sum = 0;
+        for (int dja = 1; dja <= djmax; dja += 4)
+            for (int djb = 1; djb <= djmax; djb += 4)
+                for (int djc = 1; djc <= djmax; djc += 2)
+                    for (int djd = 1; djd <= djmax; djd += 2)
+                        for (int dk1 = 0; dk1 <= 4; dk1 += 2)
+                            for (int dk2 = 0; dk2 <= 4; dk2 += 2)
+                                for (int dk = std::abs(dk1 - dk2); dk <= std::min(dk1 + dk2, 4); dk += 2)
+                                    for (int dJ = std::abs(dja - djb); dJ <= dja + djb; dJ += 2)
+                                        for (int dJp = std::abs(djc - djd); dJp <= djc + djd; dJp += 2)
+                                        {
+                                            const double x = w.f9j(dja, djb, dJ, djc, djd, dJp, dk1, dk2, dk);
+                                            sum += x;
+                                            count += x != 0;
+                                            hits += x != 0 && (dk1 == 0 || dk2 == 0 || dk == 0 || dJ == 0 || dJp == 0);
+                                        }
+        return sum;
+    });
+}
+
+// grow the table step by step, the time and the peak memory of each step should only depend on the new rows
+void time_reserve_growth()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    WignerSymbols w;
+    const int step = 400;
+    w.reserve(1600, "nmax", 0);
+    for (int nmax = 2000; nmax <= 8000; nmax += step)
+    {
+        auto t1 = timer_clock::now();
+        w.reserve(nmax, "nmax", 0);
+        auto t2 = timer_clock::now();
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        std::cout << "nmax = " << nmax << ", new rows = " << step
+                  << ", time = " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us"
+                  << ", peak RSS = " << usage.ru_maxrss / 1024 << " MB" << std::endl;
+    }
+}
+
+// the extended-exponent engine against the double one, on the always valid 6j loop
+void time_xdouble()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int N = 24;
+    BasicWignerSymbols<xdouble> xw;
+    xw.reserve(N, "2bjmax", 6);
+    wigner_init(N, "2bjmax", 6);
+    double sum[2] = {0, 0};
+    long long ms[2];
+    for (int engine = 0; engine < 2; ++engine)
+    {
+        auto t1 = timer_clock::now();
+        for (int dj1 = 0; dj1 <= N; ++dj1)
+        {
+            for (int dj2 = 0; dj2 <= N; ++dj2)
+            {
+                for (int dj4 = 0; dj4 <= N; ++dj4)
+                {
+                    for (int dj5 = wigner.isodd(dj1 + dj2 + dj4); dj5 <= N; dj5 += 2)
+                    {
+                        int dj3_min = std::max(std::abs(dj1 - dj2), std::abs(dj4 - dj5));
+                        int dj3_max = std::min(dj1 + dj2, dj4 + dj5);
+                        int dj6_min = std::max(std::abs(dj1 - dj5), std::abs(dj2 - dj4));
+                        int dj6_max = std::min(dj1 + dj5, dj2 + dj4);
+                        for (int dj3 = dj3_min; dj3 <= dj3_max; dj3 += 2)
+                        {
+                            for (int dj6 = dj6_min; dj6 <= dj6_max; dj6 += 2)
+                            {
+                                sum[engine] += engine == 0 ? wigner_6j(dj1, dj2, dj3, dj4, dj5, dj6)
+                                                           : xw.f6j(dj1, dj2, dj3, dj4, dj5, dj6);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        auto t2 = timer_clock::now();
+        ms[engine] = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+    }
+    std::cout << "time xdouble 6j, diff = " << sum[0] - sum[1] << std::endl;
+    std::cout << "double engine time = " << ms[0] << " ms" << std::endl;
+    std::cout << "xdouble engine time = " << ms[1] << " ms" << std::endl;
+}
+
+// random binomial lookups, large tables do not fit in cache
+template <typename Binomial>
+void time_binomial_lookup(const char *name, int nmax)
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    Binomial table;
+    table.reserve(nmax);
+    const int count = 10000000;
+    std::uint32_t seed = 12345;
+    double sum = 0;
+    auto t1 = timer_clock::now();
+    for (int i = 0; i < count; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int n = static_cast<int>((seed >> 8) % (nmax + 1));
+        int k = static_cast<int>((seed >> 4) % (n + 1));
+        sum += table(n, k) > 1e300 ? 1 : 0;
+    }
+    auto t2 = timer_clock::now();
+    std::cout << name << ": nmax = " << nmax << ", memory = " << table.memory() / 1024 << " KB, " << count
+              << " lookups time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << " ms"
+              << " (" << sum << ")" << std::endl;
+}
+
+template <typename Wigner>
+long long time_6j_engine(const Wigner &w, int N, double &sum)
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    auto t1 = timer_clock::now();
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+    {
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+        {
+            for (int dj4 = 0; dj4 <= N; ++dj4)
+            {
+                for (int dj5 = w.isodd(dj1 + dj2 + dj4); dj5 <= N; dj5 += 2)
+                {
+                    int dj3_min = std::max(std::abs(dj1 - dj2), std::abs(dj4 - dj5));
+                    int dj3_max = std::min(dj1 + dj2, dj4 + dj5);
+                    int dj6_min = std::max(std::abs(dj1 - dj5), std::abs(dj2 - dj4));
+                    int dj6_max = std::min(dj1 + dj5, dj2 + dj4);
+                    for (int dj3 = dj3_min; dj3 <= dj3_max; dj3 += 2)
+                    {
+                        for (int dj6 = dj6_min; dj6 <= dj6_max; dj6 += 2)
+                        {
+                            sum += w.f6j(dj1, dj2, dj3, dj4, dj5, dj6);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    auto t2 = timer_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+}
+
+void time_binomial_engines()
+{
+    for (int nmax : {200, 1000, 4000})
+    {
+        time_binomial_lookup<BinomialTable<double>>("binomial table", nmax);
+        time_binomial_lookup<FactorialTable<double>>("factorial table", nmax);
+    }
+    const int N = 24;
+    BasicWignerSymbols<double, FactorialTable<double>> fw;
+    fw.reserve(N, "2bjmax", 6);
+    wigner_init(N, "2bjmax", 6);
+    double sum[2] = {0, 0};
+    long long ms0 = time_6j_engine(wigner, N, sum[0]);
+    long long ms1 = time_6j_engine(fw, N, sum[1]);
+    std::cout << "time factorial table 6j, diff = " << sum[0] - sum[1] << std::endl;
+    std::cout << "binomial table time = " << ms0 << " ms" << std::endl;
+    std::cout << "factorial table time = " << ms1 << " ms" << std::endl;
+}
+
+template <typename T>
+void time_precision(const char *name)
+{
+    const int N = 24;
+    wigner_init<T>(N, "2bjmax", 6);
+    double sum = 0;
+    long long ms = time_6j_engine(basic_wigner<T>, N, sum);
+    std::cout << name << " 6j time = " << ms << " ms, sum = " << sum
+              << ", table memory = " << basic_wigner<T>.binomial_engine().memory() / 1024 << " KB" << std::endl;
+}
+
+void time_precisions()
+{
+    time_precision<float>("float");
+    time_precision<double>("double");
+    time_precision<long double>("long double");
+#ifdef __SIZEOF_FLOAT128__
+    time_precision<__float128>("__float128");
+#endif
+}
+
+void time_reserve_mode()
+{
+    const int N = 24;
+    WignerSymbols w;
+    w.reserve(N, "2bjmax", 6);
+    double sum[2] = {0, 0};
+    long long ms0 = time_6j_engine(w, N, sum[0]);
+    w.set_reserve_mode(ReserveMode::grow);
+    long long ms1 = time_6j_engine(w, N, sum[1]);
+    std::cout << "time reserve mode 6j, diff = " << sum[0] - sum[1] << std::endl;
+    std::cout << "unchecked mode time = " << ms0 << " ms" << std::endl;
+    std::cout << "grow mode time = " << ms1 << " ms" << std::endl;
+}
+
+// every thread computes random 6j symbols from one shared table
+template <typename Wigner>
+long long time_6j_threads(const Wigner &w, int threads, int dj_max, double &sum)
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int count = 2000000;
+    std::vector<double> sums(threads, 0);
+    std::vector<std::thread> pool;
+    auto t1 = timer_clock::now();
+    for (int id = 0; id < threads; ++id)
+    {
+        pool.emplace_back([&w, &sums, id, count, dj_max]() {
+            std::uint32_t seed = 12345 + id;
+            auto next = [&seed, dj_max]() {
+                seed = seed * 1664525u + 1013904223u;
+                return static_cast<int>((seed >> 8) % (dj_max + 1));
+            };
+            double s = 0;
+            for (int i = 0; i < count; ++i)
+            {
+                const int dj1 = next(), dj2 = next(), dj4 = next(), dj5 = next();
+                const int dj3 = std::abs(dj1 - dj2) + 2 * (next() % (std::min(dj1, dj2) + 1));
+                const int dj6 = std::abs(dj1 - dj5) + 2 * (next() % (std::min(dj1, dj5) + 1));
+                const double x = w.f6j(dj1, dj2, dj3, dj4, dj5, dj6);
+                s += std::isfinite(x) ? x : 0;
+            }
+            sums[id] = s;
+        });
+    }
+    for (auto &t : pool)
+        t.join();
+    auto t2 = timer_clock::now();
+    for (double s : sums)
+        sum += s;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+}
+
+void time_table_policy()
+{
+    const int threads = std::max(1u, std::thread::hardware_concurrency());
+    const int dj_max = 500;
+    WignerSymbols plain;
+    WignerSymbols huge(TablePolicy{true});
+    BasicWignerSymbols<double, NumaBinomialTable<double>> numa(TablePolicy{true});
+    plain.reserve(dj_max, "Jmax", 6);
+    huge.reserve(dj_max, "Jmax", 6);
+    numa.reserve(dj_max, "Jmax", 6);
+    double sum[3] = {0, 0, 0};
+    long long ms0 = time_6j_threads(plain, threads, dj_max, sum[0]);
+    long long ms1 = time_6j_threads(huge, threads, dj_max, sum[1]);
+    long long ms2 = time_6j_threads(numa, threads, dj_max, sum[2]);
+    std::cout << threads << " threads, " << numa_node_count() << " NUMA nodes, table memory = "
+              << plain.binomial_engine().memory() / 1024 << " KB" << std::endl;
+    std::cout << "default table time = " << ms0 << " ms" << std::endl;
+    std::cout << "huge page table time = " << ms1 << " ms, diff = " << sum[0] - sum[1] << std::endl;
+    std::cout << "NUMA replicated table time = " << ms2 << " ms, diff = " << sum[0] - sum[2] << std::endl;
+}
+
+// 6j symbols with `dj6 <= 2`, so the sums have at most 3 terms and the prefactor dominates
+template <typename Wigner>
+long long time_6j_short_sums(const Wigner &w, int N, double &sum)
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    auto t1 = timer_clock::now();
+    for (int repeat = 0; repeat < 3; ++repeat)
+    {
+        for (int dj1 = 0; dj1 <= N; ++dj1)
+        {
+            for (int dj2 = 0; dj2 <= N; ++dj2)
+            {
+                for (int dj6 = 0; dj6 <= 2; ++dj6)
+                {
+                    for (int dj5 = std::abs(dj1 - dj6); dj5 <= dj1 + dj6; dj5 += 2)
+                    {
+                        for (int dj4 = std::abs(dj2 - dj6); dj4 <= dj2 + dj6; dj4 += 2)
+                        {
+                            int dj3_min = std::max(std::abs(dj1 - dj2), std::abs(dj4 - dj5));
+                            int dj3_max = std::min(dj1 + dj2, dj4 + dj5);
+                            for (int dj3 = dj3_min; dj3 <= dj3_max; dj3 += 2)
+                            {
+                                sum += w.f6j(dj1, dj2, dj3, dj4, dj5, dj6);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    auto t2 = timer_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+}
+
+void time_sqrt_table()
+{
+    const int N = 24;
+    BasicWignerSymbols<double, SqrtBinomialTable<double>> sw;
+    sw.reserve(N, "2bjmax", 6);
+    wigner_init(N, "2bjmax", 6);
+    double sum[2] = {0, 0};
+    long long ms0 = time_6j_engine(wigner, N, sum[0]);
+    long long ms1 = time_6j_engine(sw, N, sum[1]);
+    std::cout << "time sqrt table 6j, diff = " << sum[0] - sum[1] << std::endl;
+    std::cout << "binomial table time = " << ms0 << " ms" << std::endl;
+    std::cout << "sqrt table time = " << ms1 << " ms, memory = " << sw.binomial_engine().memory() / 1024 << " KB"
+              << std::endl;
+    const int M = 100;
+    sw.reserve(M, "2bjmax", 6);
+    wigner_init(M, "2bjmax", 6);
+    sum[0] = sum[1] = 0;
+    ms0 = time_6j_short_sums(wigner, M, sum[0]);
+    ms1 = time_6j_short_sums(sw, M, sum[1]);
+    std::cout << "time sqrt table 6j with short sums, diff = " << sum[0] - sum[1] << std::endl;
+    std::cout << "binomial table time = " << ms0 << " ms" << std::endl;
+    std::cout << "sqrt table time = " << ms1 << " ms" << std::endl;
+}
+
+// count the nonzero 6j symbols among random arguments, the triads are not predictable
+void time_triangle_table()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int N = 40;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 2 * N);
+    std::vector<int> args(6 << 23);
+    for (auto &x : args)
+        x = dist(gen);
+    wigner_init(2 * N, "triad", 0);
+    auto t1 = timer_clock::now();
+    long long count[2] = {0, 0};
+    for (std::size_t i = 0; i < args.size(); i += 6)
+    {
+        const int *a = &args[i];
+        count[0] += WignerSymbols::check_couple(a[0], a[1], a[2]) && WignerSymbols::check_couple(a[0], a[4], a[5]) &&
+                    WignerSymbols::check_couple(a[3], a[1], a[5]) && WignerSymbols::check_couple(a[3], a[4], a[2]);
+    }
+    auto t2 = timer_clock::now();
+    const auto triad = wigner.triangle_table().snapshot();
+    for (std::size_t i = 0; i < args.size(); i += 6)
+    {
+        const int *a = &args[i];
+        count[1] += triad(a[0], a[1], a[2]) & triad(a[0], a[4], a[5]) & triad(a[3], a[1], a[5]) &
+                    triad(a[3], a[4], a[2]);
+    }
+    auto t3 = timer_clock::now();
+    std::cout << "time triad bitmap, diff = " << count[0] - count[1] << std::endl;
+    std::cout << "direct check time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+              << " ms" << std::endl;
+    std::cout << "bitmap time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count()
+              << " ms, memory = " << wigner.triangle_table().memory() / 1024 << " KB" << std::endl;
+}
+
+// CG coefficients of an m-scheme basis, one call for each coefficient and one batch call
+void time_batch()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int N = 31;
+    std::vector<int> args[6];
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+            for (int dj3 = std::abs(dj1 - dj2); dj3 <= std::min(dj1 + dj2, N); dj3 += 2)
+                for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                    for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                    {
+                        const int a[6] = {dj1, dj2, dj3, dm1, dm2, dm1 + dm2};
+                        for (int k = 0; k < 6; ++k)
+                            args[k].push_back(a[k]);
+                    }
+    const std::size_t M = args[0].size();
+    std::vector<double> out(M);
+    wigner_init(N, "Jmax", 3);
+    auto t1 = timer_clock::now();
+    double x = 0;
+    for (std::size_t i = 0; i < M; ++i)
+        x += CG(args[0][i], args[1][i], args[2][i], args[3][i], args[4][i], args[5][i]);
+    auto t2 = timer_clock::now();
+    CG(M, args[0].data(), args[1].data(), args[2].data(), args[3].data(), args[4].data(), args[5].data(), out.data());
+    auto t3 = timer_clock::now();
+    double y = 0;
+    for (double v : out)
+        y += v;
+    std::cout << "time batch CG, " << M << " coefficients, diff = " << x - y << std::endl;
+    std::cout << "scalar time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << " ms"
+              << std::endl;
+    std::cout << "batch time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << " ms"
+              << std::endl;
+}
+
+// all the CG coefficients of each triad, one call for each coefficient and one block for each triad
+void time_CG_block()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int N = 41;
+    wigner_init(N, "Jmax", 3);
+    std::vector<double> block((N + 1) * (N + 1));
+    auto t1 = timer_clock::now();
+    double x = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+            for (int dj3 = std::abs(dj1 - dj2); dj3 <= dj1 + dj2; dj3 += 2)
+                for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                    for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                        x += CG(dj1, dj2, dj3, dm1, dm2, dm1 + dm2);
+    auto t2 = timer_clock::now();
+    double y = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+            for (int dj3 = std::abs(dj1 - dj2); dj3 <= dj1 + dj2; dj3 += 2)
+            {
+                wigner.CG_block(dj1, dj2, dj3, block.data());
+                for (int i = 0; i < (dj1 + 1) * (dj2 + 1); ++i)
+                    y += block[i];
+            }
+    auto t3 = timer_clock::now();
+    std::cout << "time CG block, diff = " << x - y << std::endl;
+    std::cout << "single coefficients time = "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << " ms" << std::endl;
+    std::cout << "blocks time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << " ms"
+              << std::endl;
+}
+
+// 3j symbols of all `dj3` for each `dj1, dj2, dm1, dm2`, one `f3j` for each `dj3` and one recursion
+void time_3j_range()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int N = 40;
+    wigner_init(N, "Jmax", 3);
+    std::vector<double> range(N + 1);
+    auto t1 = timer_clock::now();
+    double x = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+            for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                    for (int dj3 = std::max(std::abs(dj1 - dj2), std::abs(dm1 + dm2)); dj3 <= dj1 + dj2; dj3 += 2)
+                        x += wigner_3j(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2);
+    auto t2 = timer_clock::now();
+    double y = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+            for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                {
+                    const int count = wigner.f3j_range(dj1, dj2, dm1, dm2, range.data());
+                    for (int k = 0; k < count; ++k)
+                        y += range[k];
+                }
+    auto t3 = timer_clock::now();
+    std::cout << "time 3j range, diff = " << x - y << std::endl;
+    std::cout << "single symbols time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+              << " ms" << std::endl;
+    std::cout << "recursion time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count()
+              << " ms" << std::endl;
+}
+
+// all `dj1` of the 6j symbols, from the single symbols and from the recursion, for all small rows and for random rows
+// with the other arguments in [30, 60]
+void time_6j_range()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int N = 16;
+    wigner_init(60, "Jmax", 6);
+    std::vector<double> range(61);
+    auto t1 = timer_clock::now();
+    double x = 0;
+    for (int dj2 = 0; dj2 <= N; ++dj2)
+        for (int dj3 = 0; dj3 <= N; ++dj3)
+            for (int dj4 = 0; dj4 <= N; ++dj4)
+                for (int dj5 = 0; dj5 <= N; ++dj5)
+                    for (int dj6 = 0; dj6 <= N; ++dj6)
+                        for (int dj1 = std::max(std::abs(dj2 - dj3), std::abs(dj5 - dj6));
+                             dj1 <= std::min(dj2 + dj3, dj5 + dj6); dj1 += 2)
+                            x += wigner_6j(dj1, dj2, dj3, dj4, dj5, dj6);
+    auto t2 = timer_clock::now();
+    double y = 0;
+    for (int dj2 = 0; dj2 <= N; ++dj2)
+        for (int dj3 = 0; dj3 <= N; ++dj3)
+            for (int dj4 = 0; dj4 <= N; ++dj4)
+                for (int dj5 = 0; dj5 <= N; ++dj5)
+                    for (int dj6 = 0; dj6 <= N; ++dj6)
+                    {
+                        const int count = wigner.f6j_range(dj2, dj3, dj4, dj5, dj6, range.data());
+                        for (int k = 0; k < count; ++k)
+                            y += range[k];
+                    }
+    auto t3 = timer_clock::now();
+    std::cout << "time 6j range, dj <= " << N << ", diff = " << x - y << std::endl;
+    std::cout << "single symbols time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+              << " ms" << std::endl;
+    std::cout << "recursion time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count()
+              << " ms" << std::endl;
+
+    std::mt19937 gen(2);
+    std::vector<std::array<int, 5>> rows;
+    while (rows.size() < 20000)
+    {
+        std::array<int, 5> r;
+        for (int &dj : r)
+            dj = 2 * std::uniform_int_distribution<int>(15, 30)(gen);
+        if (wigner.f6j_range(r[0], r[1], r[2], r[3], r[4], range.data()) > 0)
+            rows.push_back(r);
+    }
+    long long count = 0;
+    t1 = timer_clock::now();
+    x = 0;
+    for (const auto &r : rows)
+    {
+        const int dj1max = std::min(r[0] + r[1], r[3] + r[4]);
+        for (int dj1 = std::max(std::abs(r[0] - r[1]), std::abs(r[3] - r[4])); dj1 <= dj1max; dj1 += 2)
+            x += wigner_6j(dj1, r[0], r[1], r[2], r[3], r[4]);
+    }
+    t2 = timer_clock::now();
+    y = 0;
+    for (const auto &r : rows)
+    {
+        const int n = wigner.f6j_range(r[0], r[1], r[2], r[3], r[4], range.data());
+        for (int k = 0; k < n; ++k)
+            y += range[k];
+        count += n;
+    }
+    t3 = timer_clock::now();
+    std::cout << "time 6j range, " << rows.size() << " rows of " << count << " symbols, dj in [30, 60], diff = "
+              << x - y << std::endl;
+    std::cout << "single symbols time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+              << " ms" << std::endl;
+    std::cout << "recursion time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count()
+              << " ms" << std::endl;
+}
+
+// 3j symbols in random order, from `f3j` and from the Regge symmetric table
+void time_regge_table()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int N = 40;
+    std::vector<std::array<int, 6>> args;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+            for (int dj3 = std::abs(dj1 - dj2); dj3 <= std::min(dj1 + dj2, N); dj3 += 2)
+                for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                    for (int dm2 = std::max(-dj2, -dj3 - dm1); dm2 <= std::min(dj2, dj3 - dm1); dm2 += 2)
+                        args.push_back({dj1, dj2, dj3, dm1, dm2, -dm1 - dm2});
+    std::shuffle(args.begin(), args.end(), std::mt19937(0));
+    wigner_init(N, "Jmax", 3);
+    auto t1 = timer_clock::now();
+    Regge3jTable<double> table;
+    table.reserve(N);
+    auto t2 = timer_clock::now();
+    double x = 0;
+    for (const auto &a : args)
+        x += wigner.f3j(a[0], a[1], a[2], a[3], a[4], a[5]);
+    auto t3 = timer_clock::now();
+    double y = 0;
+    for (const auto &a : args)
+        y += table.f3j(a[0], a[1], a[2], a[3], a[4], a[5]);
+    auto t4 = timer_clock::now();
+    std::cout << "time Regge table, " << args.size() << " symbols, table memory = " << table.memory()
+              << " bytes, diff = " << x - y << std::endl;
+    std::cout << "build time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << " ms"
+              << std::endl;
+    std::cout << "f3j time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << " ms"
+              << std::endl;
+    std::cout << "table time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t4 - t3).count() << " ms"
+              << std::endl;
+}
+
+// the CG0 of all orbital couplings with `l <= 12` many times, like the reduced matrix elements of the multipoles,
+// from the formula and from the CG0 table
+void time_CG0_table()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int N = 12;
+    const int repeat = 20000;
+    WignerSymbols plain;
+    plain.reserve(2 * N, "Jmax", 3);
+    WignerSymbols table;
+    table.reserve(N, "CG0", 0);
+    auto t1 = timer_clock::now();
+    double x = 0;
+    for (int r = 0; r < repeat; ++r)
+        for (int l1 = 0; l1 <= N; ++l1)
+            for (int l2 = 0; l2 <= N; ++l2)
+                for (int L = std::abs(l1 - l2); L <= l1 + l2; L += 2)
+                    x += plain.CG0(l1, l2, L);
+    auto t2 = timer_clock::now();
+    double y = 0;
+    for (int r = 0; r < repeat; ++r)
+        for (int l1 = 0; l1 <= N; ++l1)
+            for (int l2 = 0; l2 <= N; ++l2)
+                for (int L = std::abs(l1 - l2); L <= l1 + l2; L += 2)
+                    y += table.CG0(l1, l2, L);
+    auto t3 = timer_clock::now();
+    double z = 0;
+    for (int r = 0; r < repeat; ++r)
+        for (int l1 = 0; l1 <= N; ++l1)
+            for (int l2 = 0; l2 <= N; ++l2)
+            {
+                const double *row = table.CG0_table().row(l1, l2);
+                for (int k = 0; k <= std::min(l1, l2); ++k)
+                    z += row[k];
+            }
+    auto t4 = timer_clock::now();
+    std::cout << "time CG0 table, table memory = " << table.CG0_table().memory() << " bytes, diff = " << x - y
+              << ", " << x - z << std::endl;
+    std::cout << "formula time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << " ms"
+              << std::endl;
+    std::cout << "table time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << " ms"
+              << std::endl;
+    std::cout << "row time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t4 - t3).count() << " ms"
+              << std::endl;
+}
+
+// a Delta, isospin 3/2, coupled with two nucleons, the compile time table against two `CG` calls
+void time_CGfixed()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int repeat = 100000;
+    WignerSymbols w;
+    w.reserve(5, "Jmax", 3);
+    auto t1 = timer_clock::now();
+    double x = 0;
+    for (int r = 0; r < repeat; ++r)
+        for (int dm1 = -3; dm1 <= 3; dm1 += 2)
+            for (int dm2 = -1; dm2 <= 1; dm2 += 2)
+                for (int dm3 = -1; dm3 <= 1; dm3 += 2)
+                    for (int dT12 = 2; dT12 <= 4; dT12 += 2)
+                        for (int dT = 1; dT <= 5; dT += 2)
+                            x += w.CG(3, 1, dT12, dm1, dm2, dm1 + dm2) *
+                                 w.CG(dT12, 1, dT, dm1 + dm2, dm3, dm1 + dm2 + dm3);
+    auto t2 = timer_clock::now();
+    double y = 0;
+    for (int r = 0; r < repeat; ++r)
+        for (int dm1 = -3; dm1 <= 3; dm1 += 2)
+            for (int dm2 = -1; dm2 <= 1; dm2 += 2)
+                for (int dm3 = -1; dm3 <= 1; dm3 += 2)
+                    for (int dT12 = 2; dT12 <= 4; dT12 += 2)
+                        for (int dT = 1; dT <= 5; dT += 2)
+                            y += CG3fixed<3, 1, 1>(dm1, dm2, dm3, dT12, dT);
+    auto t3 = timer_clock::now();
+    std::cout << "time CGfixed, diff = " << x - y << std::endl;
+    std::cout << "CG time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << " ms"
+              << std::endl;
+    std::cout << "CG3fixed time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << " ms"
+              << std::endl;
+}
+
+// the recoupling matrices of all `j1, j2, j3 <= 21/2` and `J`, built from `wigner_6j` and by `RecouplingMatrix`, and
+// each applied to 256 vectors, as in an antisymmetrizer of three particles
+void time_recoupling_matrix()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int djmax = 21, ncol = 256;
+    wigner_init(3 * djmax, "Jmax", 6);
+    std::vector<double> dense((djmax + 1) * (djmax + 1)), x((djmax + 1) * ncol), y((djmax + 1) * ncol);
+    for (std::size_t i = 0; i < x.size(); ++i)
+        x[i] = std::sin(1.0 + i);
+    long long count = 0;
+    double s1 = 0, s2 = 0;
+    auto t1 = timer_clock::now();
+    for (int dj1 = 1; dj1 <= djmax; dj1 += 2)
+        for (int dj2 = 1; dj2 <= djmax; dj2 += 2)
+            for (int dj3 = 1; dj3 <= djmax; dj3 += 2)
+                for (int dJ = 1; dJ <= dj1 + dj2 + dj3; dJ += 2)
+                {
+                    const int dJ12min = std::max(std::abs(dj1 - dj2), std::abs(dj3 - dJ));
+                    const int dJ23min = std::max(std::abs(dj2 - dj3), std::abs(dj1 - dJ));
+                    const int n = std::max(0, (std::min(dj1 + dj2, dj3 + dJ) - dJ12min) / 2 + 1);
+                    const double sign = (dj1 + dj2 + dj3 + dJ) / 2 % 2 ? -1 : 1;
+                    for (int a = 0; a < n; ++a)
+                        for (int b = 0; b < n; ++b)
+                        {
+                            const int dJ12 = dJ12min + 2 * a, dJ23 = dJ23min + 2 * b;
+                            dense[a * n + b] = sign * std::sqrt((dJ12 + 1.0) * (dJ23 + 1.0)) *
+                                               wigner_6j(dj1, dj2, dJ12, dj3, dJ, dJ23);
+                        }
+                    for (int a = 0; a < n * n; ++a)
+                        s1 += dense[a] * dense[a];
+                    count += n * n;
+                }
+    auto t2 = timer_clock::now();
+    RecouplingMatrix<double> R(0, 0, 0, 0);
+    for (int dj1 = 1; dj1 <= djmax; dj1 += 2)
+        for (int dj2 = 1; dj2 <= djmax; dj2 += 2)
+            for (int dj3 = 1; dj3 <= djmax; dj3 += 2)
+                for (int dJ = 1; dJ <= dj1 + dj2 + dj3; dJ += 2)
+                {
+                    R.assign(dj1, dj2, dj3, dJ);
+                    for (int a = 0; a < R.dim() * R.dim(); ++a)
+                        s2 += R.data()[a] * R.data()[a];
+                }
+    auto t3 = timer_clock::now();
+    for (int dj1 = 1; dj1 <= djmax; dj1 += 2)
+        for (int dj2 = 1; dj2 <= djmax; dj2 += 2)
+            for (int dj3 = 1; dj3 <= djmax; dj3 += 2)
+                for (int dJ = 1; dJ <= dj1 + dj2 + dj3; dJ += 2)
+                {
+                    R.assign(dj1, dj2, dj3, dJ);
+                    R.apply(x.data(), y.data(), ncol);
+                }
+    auto t4 = timer_clock::now();
+    std::cout << "time recoupling matrix, djmax = " << djmax << ", " << count << " entries, diff = " << s1 - s2
+              << std::endl;
+    std::cout << "wigner_6j time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << " ms"
+              << std::endl;
+    std::cout << "RecouplingMatrix time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count()
+              << " ms" << std::endl;
+    std::cout << "build and apply to " << ncol << " vectors time = "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t4 - t3).count() << " ms" << std::endl;
+}
+
+// the coupling matrix of `j1 = j2 = 10`, assembled densely from `CG` against the blocks, and applied to 64 vectors
+void time_coupling_matrix()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int dj = 20, ncol = 64, repeat = 20;
+    const int n = (dj + 1) * (dj + 1);
+    WignerSymbols w;
+    w.reserve(2 * dj, "Jmax", 3);
+    std::vector<double> dense(n * n), x(n * ncol), y(n * ncol), z(n * ncol);
+    for (int i = 0; i < n * ncol; ++i)
+        x[i] = std::sin(1.0 + i);
+    const CouplingMatrix<double> U0(dj, dj);
+    auto t1 = timer_clock::now();
+    for (int r = 0; r < repeat; ++r)
+    {
+        std::fill(dense.begin(), dense.end(), 0.0);
+        for (int dJ = 0; dJ <= 2 * dj; dJ += 2)
+            for (int dm1 = -dj; dm1 <= dj; dm1 += 2)
+                for (int dm2 = -dj; dm2 <= dj; dm2 += 2)
+                    if (std::abs(dm1 + dm2) <= dJ)
+                        dense[U0.coupled_index(dJ, dm1 + dm2) * n + U0.product_index(dm1, dm2)] =
+                            w.CG(dj, dj, dJ, dm1, dm2, dm1 + dm2);
+    }
+    auto t2 = timer_clock::now();
+    for (int r = 0; r < repeat; ++r)
+    {
+        const CouplingMatrix<double> U(dj, dj);
+        y[r] += U.block(0)[0];
+    }
+    auto t3 = timer_clock::now();
+    for (int r = 0; r < repeat; ++r)
+    {
+        std::fill(y.begin(), y.end(), 0.0);
+        for (int i = 0; i < n; ++i)
+            for (int k = 0; k < n; ++k)
+                for (int j = 0; j < ncol; ++j)
+                    y[i * ncol + j] += dense[i * n + k] * x[k * ncol + j];
+    }
+    auto t4 = timer_clock::now();
+    for (int r = 0; r < repeat; ++r)
+        U0.apply(x.data(), z.data(), ncol);
+    auto t5 = timer_clock::now();
+    double diff = 0;
+    for (int i = 0; i < n * ncol; ++i)
+        diff += std::abs(y[i] - z[i]);
+    std::cout << "time coupling matrix, dense memory = " << n * n * sizeof(double)
+              << " bytes, block memory = " << U0.memory() << " bytes, diff = " << diff << std::endl;
+    std::cout << "dense CG time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << " ms"
+              << std::endl;
+    std::cout << "block build time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count()
+              << " ms" << std::endl;
+    std::cout << "dense apply time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t4 - t3).count()
+              << " ms" << std::endl;
+    std::cout << "block apply time = " << std::chrono::duration_cast<std::chrono::milliseconds>(t5 - t4).count()
+              << " ms" << std::endl;
+}
+
+// the product of two expansions in `Y_{lm}` with `lmax = 8`, from two `wigner_3j` calls for each coefficient, from
+// `Gaunt`, and streamed from `GauntTable`
+void time_Gaunt()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int lmax = 8, repeat = 20;
+    const int n = (lmax + 1) * (lmax + 1), N = (2 * lmax + 1) * (2 * lmax + 1);
+    const double pi = 3.141592653589793;
+    wigner_init(2 * lmax, "Jmax", 3);
+    std::vector<double> a(n), b(n), c(N), d(N), e(N);
+    for (int i = 0; i < n; ++i)
+        a[i] = std::sin(1.0 + i), b[i] = std::cos(2.0 + 3 * i);
+    auto lm = [](int l, int m) { return l * (l + 1) + m; };
+    auto t1 = timer_clock::now();
+    for (int r = 0; r < repeat; ++r)
+    {
+        std::fill(c.begin(), c.end(), 0.0);
+        for (int l1 = 0; l1 <= lmax; ++l1)
+            for (int m1 = -l1; m1 <= l1; ++m1)
+                for (int l2 = 0; l2 <= lmax; ++l2)
+                    for (int m2 = -l2; m2 <= l2; ++m2)
+                        for (int L = std::abs(m1 + m2); L <= 2 * lmax; ++L)
+                        {
+                            const double x = std::sqrt((2 * l1 + 1) * (2 * l2 + 1) * (2 * L + 1) / (4 * pi)) *
+                                             wigner_3j(2 * l1, 2 * l2, 2 * L, 0, 0, 0) *
+                                             wigner_3j(2 * l1, 2 * l2, 2 * L, 2 * m1, 2 * m2, -2 * (m1 + m2));
+                            c[lm(L, m1 + m2)] += ((m1 + m2) % 2 == 0 ? x : -x) * a[lm(l1, m1)] * b[lm(l2, m2)];
+                        }
+    }
+    auto t2 = timer_clock::now();
+    for (int r = 0; r < repeat; ++r)
+    {
+        std::fill(d.begin(), d.end(), 0.0);
+        for (int l1 = 0; l1 <= lmax; ++l1)
+            for (int m1 = -l1; m1 <= l1; ++m1)
+                for (int l2 = 0; l2 <= lmax; ++l2)
+                    for (int m2 = -l2; m2 <= l2; ++m2)
+                        for (int L = std::abs(m1 + m2); L <= 2 * lmax; ++L)
+                        {
+                            const double x = Gaunt(l1, l2, L, m1, m2, -m1 - m2);
+                            d[lm(L, m1 + m2)] += ((m1 + m2) % 2 == 0 ? x : -x) * a[lm(l1, m1)] * b[lm(l2, m2)];
+                        }
+    }
+    auto t3 = timer_clock::now();
+    const GauntTable<double> table(lmax);
+    auto t4 = timer_clock::now();
+    for (int r = 0; r < repeat; ++r)
+        table.product(a.data(), b.data(), e.data());
+    auto t5 = timer_clock::now();
+    double diff = 0;
+    for (int i = 0; i < N; ++i)
+        diff += std::abs(c[i] - d[i]) + std::abs(c[i] - e[i]);
+    std::cout << "time Gaunt, table memory = " << table.memory() << " bytes, diff = " << diff << std::endl;
+    std::cout << "two 3j time = " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us"
+              << std::endl;
+    std::cout << "Gaunt time = " << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() << " us"
+              << std::endl;
+    std::cout << "table build time = " << std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count()
+              << " us" << std::endl;
+    std::cout << "table product time = " << std::chrono::duration_cast<std::chrono::microseconds>(t5 - t4).count()
+              << " us" << std::endl;
+}
+
+// A Pandya transform like workload, `{ja jb J; jc jd J'}` over the orbits with `djmin <= dj <= djmax` and all `J, J'`,
+// where each symbol comes up many times, uncached and through `Wigner6jCache`, in one and in 4 threads.
+void time_6j_cache(int djmin, int djmax)
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int nthread = 4;
+    wigner_init(2 * djmax, "Jmax", 6);
+    Wigner6jCache<double> cache;
+    auto workload = [djmin, djmax](auto &&f6j) {
+        double sum = 0;
+        for (int dJp = 0; dJp <= 2 * djmax; dJp += 2)
+            for (int dja = djmin; dja <= djmax; dja += 2)
+                for (int djb = djmin; djb <= djmax; djb += 2)
+                    for (int djc = djmin; djc <= djmax; djc += 2)
+                        for (int djd = djmin; djd <= djmax; djd += 2)
+                            for (int dJ = 0; dJ <= 2 * djmax; dJ += 2)
+                                sum += f6j(dja, djb, dJ, djc, djd, dJp);
+        return sum;
+    };
+    auto uncached = [](int dj1, int dj2, int dj3, int dj4, int dj5, int dj6) {
+        return wigner_6j(dj1, dj2, dj3, dj4, dj5, dj6);
+    };
+    auto cached = [&cache](int dj1, int dj2, int dj3, int dj4, int dj5, int dj6) {
+        return cache.f6j(dj1, dj2, dj3, dj4, dj5, dj6);
+    };
+    auto threaded = [&](auto &&f6j) {
+        std::vector<std::thread> threads;
+        std::vector<double> sums(nthread);
+        for (int t = 0; t < nthread; ++t)
+            threads.emplace_back([&, t] { sums[t] = workload(f6j); });
+        for (auto &t : threads)
+            t.join();
+        return sums[0];
+    };
+    auto t1 = timer_clock::now();
+    const double x = workload(uncached);
+    auto t2 = timer_clock::now();
+    const double y = workload(cached);
+    auto t3 = timer_clock::now();
+    const double z = workload(cached);
+    auto t4 = timer_clock::now();
+    threaded(uncached);
+    auto t5 = timer_clock::now();
+    threaded(cached);
+    auto t6 = timer_clock::now();
+    const auto stats = cache.stats();
+    std::cout << "time 6j cache, dj in [" << djmin << ", " << djmax << "], " << cache.size()
+              << " symbols, hit rate = " << stats.hit_rate() << ", front hits = " << stats.front_hits
+              << ", shared hits = " << stats.shared_hits << ", sampled latency = " << stats.latency_ns()
+              << " ns, diff = " << std::abs(x - y) + std::abs(x - z) << std::endl;
+    std::cout << "wigner_6j time = " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us"
+              << std::endl;
+    std::cout << "cache first pass time = " << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count()
+              << " us" << std::endl;
+    std::cout << "cache second pass time = " << std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count()
+              << " us" << std::endl;
+    std::cout << nthread << " threads wigner_6j time = "
+              << std::chrono::duration_cast<std::chrono::microseconds>(t5 - t4).count() << " us" << std::endl;
+    std::cout << nthread << " threads cache time = "
+              << std::chrono::duration_cast<std::chrono::microseconds>(t6 - t5).count() << " us" << std::endl;
+}
+
+// A Pandya transform, `{ja jb J; jc jd J'}` over the orbits with `j <= 21/2`, `J` of `ja, jb` and `J'` of `ja, jd`,
+// from the dense table
+void time_6j_table()
+{
+    using timer_clock = std::chrono::high_resolution_clock;
+    const int djmax = 21;
+    wigner_init(2 * djmax, "Jmax", 6);
+    auto workload = [djmax](auto &&f6j) {
+        double sum = 0;
+        for (int dja = 1; dja <= djmax; dja += 2)
+            for (int djb = 1; djb <= djmax; djb += 2)
+                for (int djc = 1; djc <= djmax; djc += 2)
+                    for (int djd = 1; djd <= djmax; djd += 2)
+                        for (int dJ = std::abs(dja - djb); dJ <= dja + djb; dJ += 2)
+                            for (int dJp = std::abs(dja - djd); dJp <= dja + djd; dJp += 2)
+                                sum += f6j(dja, djb, dJ, djc, djd, dJp);
+        return sum;
+    };
+    auto t1 = timer_clock::now();
+    const double x = workload([](int dj1, int dj2, int dj3, int dj4, int dj5, int dj6) {
+        return wigner_6j(dj1, dj2, dj3, dj4, dj5, dj6);
+    });
+    auto t2 = timer_clock::now();
+    const Wigner6jTable<double> table(djmax);
+    auto t3 = timer_clock::now();
+    const double y = workload([&table](int dj1, int dj2, int dj3, int dj4, int dj5, int dj6) {
+        return table.f6j(dj1, dj2, dj3, dj4, dj5, dj6);
+    });
+    auto t4 = timer_clock::now();
+    std::cout << "time 6j table, djmax = " << djmax << ", memory = " << table.memory()
+              << " bytes, diff = " << std::abs(x - y) << std::endl;
+    std::cout << "wigner_6j time = " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us"
+              << std::endl;
+    std::cout << "table build time = " << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count()
+              << " us" << std::endl;
+    std::cout << "table time = " << std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count() << " us"
+              << std::endl;
+}
+
 int main()
 {
     std::cout << "----- test where most results are zeros -----" << std::endl;
     time_3j();
     time_6j();
     time_9j();
+    time_triangle_table();
     std::cout << "----- test where arguements are always valid -----" << std::endl;
     time_3j_always_valid();
     time_6j_always_valid();
     time_9j_always_valid();
+    time_batch();
+    time_CG_block();
+    time_3j_range();
+    time_6j_range();
+    time_regge_table();
+    time_CG0_table();
+    time_CGfixed();
+    time_coupling_matrix();
+    time_recoupling_matrix();
+    time_Gaunt();
+    time_6j_cache(1, 21);
+    time_6j_cache(61, 69);
+    time_6j_table();
     std::cout << "----- test lsjj -----" << std::endl;
     time_lsjj();
+    time_closed_forms();
+    std::cout << "----- test reserve growth -----" << std::endl;
+    time_reserve_growth();
+    time_reserve_mode();
+    std::cout << "----- test table policy -----" << std::endl;
+    time_table_policy();
+    std::cout << "----- test engines -----" << std::endl;
+    time_xdouble();
+    time_binomial_engines();
+    time_sqrt_table();
+    std::cout << "----- test precisions -----" << std::endl;
+    time_precisions();
     return 0;
 }
@@ -1,8 +1,10 @@
 #include "WignerSymbol.hpp"
+#include <complex>
 #include <functional>
 #include <gsl/gsl_specfunc.h>
 #include <iostream>
 #include <random>
+#include <thread>
 
 constexpr double sqrt_2 = 1.41421356237309504880;
 
@@ -189,6 +191,32 @@ void test_Moshinsky()
     std::cout << "test Moshinsky, diff = " << diff << std::endl;
 }
 
+// the Wigner d matrices against `d(a) d(b) = d(a + b)`, and `d^j_00(beta) = P_j(cos(beta))` for large `j`, where the
+// terms of the alternating sum underflow at small `beta` and cancel at large `beta`
+void test_dfunc()
+{
+    WignerSymbols w;
+    w.reserve(60, "nmax", 0);
+    const double angles[][2] = {{0.4, 0.7}, {0.0, 1.1}, {1.3, 2.9}, {2.0, -0.8}};
+    double diff = 0;
+    for (int dj = 0; dj <= 40; ++dj)
+        for (auto &ab : angles)
+            for (int dm1 = -dj; dm1 <= dj; dm1 += 2)
+                for (int dm2 = -dj; dm2 <= dj; dm2 += 2)
+                {
+                    double x = 0;
+                    for (int dm = -dj; dm <= dj; dm += 2)
+                        x += w.dfunc(dj, dm1, dm, ab[0]) * w.dfunc(dj, dm, dm2, ab[1]);
+                    diff += std::abs(x - w.dfunc(dj, dm1, dm2, ab[0] + ab[1]));
+                }
+    double diff_legendre = 0;
+    for (int dj : {120, 240, 400})
+        for (double beta : {1e-3, 0.05, 1.0})
+            diff_legendre =
+                std::max(diff_legendre, std::abs(w.dfunc(dj, 0, 0, beta) - std::legendre(dj / 2, std::cos(beta))));
+    std::cout << "test dfunc, diff = " << diff << ", Legendre diff = " << diff_legendre << std::endl;
+}
+
 void test_CGspin()
 {
     std::mt19937 gen(0);
@@ -247,7 +275,10 @@ void test_CGspin()
 void test_lsjj()
 {
     const int Lmax = 20;
-    wigner_init(2 * Lmax, "Jmax", 9);
+    // `f9j` reduces these to `lsjj` itself, so the reference is the general sum
+    WignerSymbols w;
+    w.reserve(2 * Lmax, "Jmax", 9);
+    w.set_closed_forms(false);
     double lsjj_sum = 0;
     double norm9j_sum = 0;
     for (int l1 = 0; l1 <= Lmax; ++l1)
@@ -264,7 +295,7 @@ void test_lsjj()
                     for (auto [S, J] : SJ_pairs)
                     {
                         double x = lsjj(l1, l2, dj1, dj2, L, S, J);
-                        double y = wigner_norm9j(2 * l1, 1, dj1, 2 * l2, 1, dj2, 2 * L, 2 * S, 2 * J);
+                        double y = w.norm9j(2 * l1, 1, dj1, 2 * l2, 1, dj2, 2 * L, 2 * S, 2 * J);
                         if (std::abs(x - y) > 1e-10)
                         {
                             std::cout << "l1 = " << l1 << ", l2 = " << l2 << ", dj1 = " << dj1 << ", dj2 = " << dj2
@@ -281,6 +312,924 @@ void test_lsjj()
     std::cout << "test lsjj, diff = " << std::abs(lsjj_sum - norm9j_sum) << std::endl;
 }
 
+// the closed forms of the 6j symbols with a small argument and of the 9j symbols with a 0 or a line (1/2, 1/2, S)
+// against the general sums, in all positions, and the 6j symbols with large j against the recursion
+void test_closed_forms()
+{
+    const int N = 40;
+    WignerSymbols w, general;
+    w.reserve(3 * N, "Jmax", 9);
+    general.reserve(3 * N, "Jmax", 9);
+    general.set_closed_forms(false);
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> big(0, N), small(0, 4), pos(0, 8);
+    double diff6 = 0, diff9 = 0, diff_large = 0;
+    int count6 = 0, count9 = 0;
+    while (count6 < 20000)
+    {
+        int d[6];
+        for (int &x : d)
+            x = big(gen);
+        d[pos(gen) % 6] = small(gen);
+        const double x = w.f6j(d[0], d[1], d[2], d[3], d[4], d[5]);
+        count6 += x != 0;
+        diff6 += std::abs(x - general.f6j(d[0], d[1], d[2], d[3], d[4], d[5]));
+    }
+    while (count9 < 5000)
+    {
+        int d[9];
+        for (int &x : d)
+            x = big(gen) / 2;
+        // a 0, or two 1/2 in a row or a column
+        const int i = pos(gen), j = pos(gen);
+        if (count9 % 2 == 0)
+            d[i] = 0;
+        else if (j % 2 == 0)
+            d[i] = d[i / 3 * 3 + (i + 1) % 3] = 1;
+        else
+            d[i] = d[(i + 3) % 9] = 1;
+        const double x = w.f9j(d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7], d[8]);
+        count9 += x != 0;
+        diff9 += std::abs(x - general.f9j(d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7], d[8]));
+    }
+    // `{j1 1000 j3; j4 600 j6}` with `j4 <= 1` for all `j1`, relative to the largest one
+    std::vector<double> row(4001);
+    for (int dj4 = 0; dj4 <= 2; ++dj4)
+        for (int t3 = -dj4; t3 <= dj4; t3 += 2)
+            for (int t6 = -dj4; t6 <= dj4; t6 += 2)
+            {
+                const int dj2 = 2000, dj3 = 1200 + t3, dj5 = 1200, dj6 = 2000 + t6;
+                const int count = w.f6j_range(dj2, dj3, dj4, dj5, dj6, row.data());
+                const int dj1min = std::max(std::abs(dj2 - dj3), std::abs(dj5 - dj6));
+                double largest = 0, d = 0;
+                for (int k = 0; k < count; ++k)
+                {
+                    largest = std::max(largest, std::abs(row[k]));
+                    d = std::max(d, std::abs(row[k] - w.f6j(dj1min + 2 * k, dj2, dj3, dj4, dj5, dj6)));
+                }
+                diff_large = std::max(diff_large, count > 0 ? d / largest : 1.0);
+            }
+    std::cout << "test closed forms, 6j diff = " << diff6 << ", 9j diff = " << diff9 << ", large j 6j diff = "
+              << diff_large << std::endl;
+}
+
+// the extended-exponent engine should agree with the double one, and it does not overflow for large j
+void test_xdouble()
+{
+    BasicWignerSymbols<xdouble> xw;
+    const int N = 20;
+    xw.reserve(N, "Jmax", 6);
+    wigner_init(N, "Jmax", 6);
+    double diff = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+    {
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+        {
+            for (int dj3 = std::abs(dj1 - dj2); dj3 <= dj1 + dj2; dj3 += 2)
+            {
+                for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                {
+                    for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                    {
+                        diff += std::abs(xw.f3j(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2) -
+                                         wigner_3j(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2));
+                    }
+                }
+                for (int dj4 = 0; dj4 <= N; dj4 += 3)
+                {
+                    for (int dj5 = 0; dj5 <= N; ++dj5)
+                    {
+                        diff += std::abs(xw.f6j(dj1, dj2, dj3, dj4, dj5, dj3) -
+                                         wigner_6j(dj1, dj2, dj3, dj4, dj5, dj3));
+                    }
+                }
+            }
+        }
+    }
+    // <j,m;j,-m|0,0> = (-1)^(j-m)/sqrt(2j+1) and {a b c; 0 c b} = (-1)^(a+b+c)/sqrt((2b+1)(2c+1))
+    const int dj = 3000;
+    xw.reserve(dj + 64, "nmax", 0);
+    for (int dm = -dj; dm <= dj; dm += 2)
+    {
+        double x = xw.CG(dj, dj, 0, dm, -dm, 0);
+        double y = WignerSymbols::iphase((dj - dm) / 2) / std::sqrt(dj + 1.);
+        diff += std::abs(x - y);
+    }
+    for (int b = 0; b <= 40; ++b)
+    {
+        double x = xw.f6j(dj + b, b, dj, 0, dj, b);
+        double y = WignerSymbols::iphase((2 * dj + 2 * b) / 2) / std::sqrt((b + 1.) * (dj + 1.));
+        diff += std::abs(x - y);
+    }
+    std::cout << "test xdouble, diff = " << diff << std::endl;
+}
+
+// several threads grow a shared table lazily while the others are reading it
+void test_concurrent_reserve()
+{
+    const int N = 24;
+    wigner_init(N, "Jmax", 6);
+    WignerSymbols w;
+    std::vector<double> diffs(4, 0.0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&w, &diffs, t, N]() {
+            for (int n = t + 1; n <= N; n += 4)
+            {
+                w.reserve(n, "Jmax", 6);
+                for (int dj1 = 0; dj1 <= 2 * n; ++dj1)
+                {
+                    for (int dj2 = 0; dj2 <= 2 * n; dj2 += 3)
+                    {
+                        for (int dj3 = std::abs(dj1 - dj2); dj3 <= std::min(dj1 + dj2, 2 * n); dj3 += 2)
+                        {
+                            double x = w.f6j(dj1, dj2, dj3, 2 * n, dj3, 2 * n - 2);
+                            double y = wigner_6j(dj1, dj2, dj3, 2 * n, dj3, 2 * n - 2);
+                            diffs[t] += std::abs(x - y);
+                        }
+                    }
+                }
+            }
+        });
+    }
+    for (auto &th : threads)
+        th.join();
+    std::cout << "test concurrent reserve, diff = " << diffs[0] + diffs[1] + diffs[2] + diffs[3] << std::endl;
+}
+
+// factorial engine vs binomial table
+void test_factorial_table()
+{
+    BasicWignerSymbols<double, FactorialTable<double>> fw;
+    const int N = 20;
+    fw.reserve(N, "Jmax", 9);
+    wigner_init(N, "Jmax", 9);
+    double diff = 0;
+    for (int n = 0; n <= fw.nmax(); ++n)
+    {
+        for (int k = 0; k <= n; ++k)
+        {
+            diff += std::abs(fw.binomial(n, k) / wigner.binomial(n, k) - 1);
+        }
+    }
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+    {
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+        {
+            for (int dj3 = std::abs(dj1 - dj2); dj3 <= dj1 + dj2; dj3 += 2)
+            {
+                for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                {
+                    for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                    {
+                        diff += std::abs(fw.f3j(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2) -
+                                         wigner_3j(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2));
+                    }
+                }
+                for (int dj4 = 0; dj4 <= N; dj4 += 3)
+                {
+                    for (int dj5 = 0; dj5 <= N; ++dj5)
+                    {
+                        diff += std::abs(fw.f6j(dj1, dj2, dj3, dj4, dj5, dj3) -
+                                         wigner_6j(dj1, dj2, dj3, dj4, dj5, dj3));
+                        diff += std::abs(fw.f9j(dj1, dj2, dj3, dj4, dj5, dj3, dj1, dj2, dj2) -
+                                         wigner_9j(dj1, dj2, dj3, dj4, dj5, dj3, dj1, dj2, dj2));
+                    }
+                }
+            }
+        }
+    }
+    // the same identity as `test_xdouble` with the O(n) memory engine
+    BasicWignerSymbols<xdouble, FactorialTable<xdouble>> xw;
+    const int dj = 3000;
+    xw.reserve(dj + 64, "nmax", 0);
+    for (int dm = -dj; dm <= dj; dm += 2)
+    {
+        double x = xw.CG(dj, dj, 0, dm, -dm, 0);
+        double y = WignerSymbols::iphase((dj - dm) / 2) / std::sqrt(dj + 1.);
+        diff += std::abs(x - y);
+    }
+    std::cout << "test factorial table, diff = " << diff << std::endl;
+}
+
+// the free functions of the other precisions vs `double`
+template <typename T>
+void test_precision(const char *name)
+{
+    const int N = 16;
+    wigner_init<T>(N, "Jmax", 9);
+    wigner_init(N, "Jmax", 9);
+    double diff = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+    {
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+        {
+            for (int dj3 = std::abs(dj1 - dj2); dj3 <= dj1 + dj2; dj3 += 2)
+            {
+                for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                {
+                    for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                    {
+                        double x = static_cast<double>(wigner_3j<T>(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2));
+                        diff += std::abs(x - wigner_3j(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2));
+                    }
+                }
+                for (int dj4 = 0; dj4 <= N; dj4 += 3)
+                {
+                    for (int dj5 = 0; dj5 <= N; ++dj5)
+                    {
+                        double x = static_cast<double>(wigner_6j<T>(dj1, dj2, dj3, dj4, dj5, dj3));
+                        diff += std::abs(x - wigner_6j(dj1, dj2, dj3, dj4, dj5, dj3));
+                        x = static_cast<double>(wigner_9j<T>(dj1, dj2, dj3, dj4, dj5, dj3, dj1, dj2, dj2));
+                        diff += std::abs(x - wigner_9j(dj1, dj2, dj3, dj4, dj5, dj3, dj1, dj2, dj2));
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "test " << name << ", diff = " << diff << std::endl;
+}
+
+// a binomial engine that counts the lookups beyond its `nmax()`, the limit is reset before each symbol
+struct CheckedBinomial
+{
+    BinomialTable<double> table;
+    mutable int limit = 0;
+    mutable long long violations = 0;
+    int nmax() const { return limit; }
+    void reserve(int nmax)
+    {
+        table.reserve(nmax);
+        limit = std::max(limit, nmax);
+    }
+    double operator()(int n, int k) const
+    {
+        violations += n > limit;
+        return table(n, k);
+    }
+};
+
+// the `grow` mode must reserve at the entry every binomial the symbol uses
+void test_reserve_mode()
+{
+    BasicWignerSymbols<double, CheckedBinomial> w;
+    w.set_reserve_mode(ReserveMode::grow);
+    const CheckedBinomial &engine = w.binomial_engine();
+    const int N = 12;
+    wigner_init(N, "Jmax", 9);
+    double diff = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+    {
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+        {
+            for (int dj3 = std::abs(dj1 - dj2); dj3 <= dj1 + dj2; dj3 += 2)
+            {
+                for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                {
+                    for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                    {
+                        engine.limit = 0;
+                        diff += std::abs(w.f3j(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2) -
+                                         wigner_3j(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2));
+                        engine.limit = 0;
+                        diff += std::abs(w.CG(dj1, dj2, dj3, dm1, dm2, dm1 + dm2) -
+                                         CG(dj1, dj2, dj3, dm1, dm2, dm1 + dm2));
+                    }
+                }
+                engine.limit = 0;
+                diff += std::abs(w.CG0(dj1, dj2, dj3) - CG0(dj1, dj2, dj3));
+                for (int dj4 = 0; dj4 <= N; ++dj4)
+                {
+                    for (int dj5 = 0; dj5 <= N; ++dj5)
+                    {
+                        for (int dj6 = 0; dj6 <= N; dj6 += 3)
+                        {
+                            engine.limit = 0;
+                            diff += std::abs(w.f6j(dj1, dj2, dj3, dj4, dj5, dj6) -
+                                             wigner_6j(dj1, dj2, dj3, dj4, dj5, dj6));
+                            engine.limit = 0;
+                            diff += std::abs(w.f9j(dj1, dj2, dj3, dj4, dj5, dj6, dj1, dj4, dj6) -
+                                             wigner_9j(dj1, dj2, dj3, dj4, dj5, dj6, dj1, dj4, dj6));
+                        }
+                    }
+                }
+            }
+            for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+            {
+                engine.limit = 0;
+                diff += std::abs(w.dfunc(dj1, dm1, dj1 - 2 * (dj2 % (dj1 + 1)), 0.7) -
+                                 dfunc(dj1, dm1, dj1 - 2 * (dj2 % (dj1 + 1)), 0.7));
+            }
+        }
+    }
+    wigner_init(2, "Moshinsky", 0);
+    for (int idx = 0; idx < 13; ++idx)
+    {
+        Moshinsky_case m = Moshinsky_test_set[idx];
+        engine.limit = 0;
+        double x = w.Moshinsky(m.N, m.L, m.n, m.l, m.n1, m.l1, m.n2, m.l2, m.Lambda, 0.5);
+        diff += std::abs(x - Moshinsky(m.N, m.L, m.n, m.l, m.n1, m.l1, m.n2, m.l2, m.Lambda, 0.5));
+    }
+    std::cout << "test reserve mode, diff = " << diff << ", lookups beyond nmax = " << engine.violations
+              << std::endl;
+}
+
+// huge page and NUMA replicated tables vs the default one
+void test_table_policy()
+{
+    const int N = 20;
+    BasicWignerSymbols<double> hw(TablePolicy{true, 0});
+    BasicWignerSymbols<double, NumaBinomialTable<double>> nw(TablePolicy{true});
+    hw.reserve(N, "Jmax", 9);
+    nw.reserve(N, "Jmax", 9);
+    wigner_init(N, "Jmax", 9);
+    double diff = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+    {
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+        {
+            for (int dj3 = std::abs(dj1 - dj2); dj3 <= dj1 + dj2; dj3 += 2)
+            {
+                for (int dj4 = 0; dj4 <= N; dj4 += 3)
+                {
+                    for (int dj5 = 0; dj5 <= N; ++dj5)
+                    {
+                        double y = wigner_9j(dj1, dj2, dj3, dj4, dj5, dj3, dj1, dj2, dj2);
+                        diff += std::abs(hw.f9j(dj1, dj2, dj3, dj4, dj5, dj3, dj1, dj2, dj2) - y);
+                        diff += std::abs(nw.f9j(dj1, dj2, dj3, dj4, dj5, dj3, dj1, dj2, dj2) - y);
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "test table policy, diff = " << diff << std::endl;
+}
+
+// prefactors from the companion square root tables
+void test_sqrt_table()
+{
+    BasicWignerSymbols<double, SqrtBinomialTable<double>> sw;
+    const int N = 16;
+    sw.reserve(N, "Jmax", 9);
+    wigner_init(N, "Jmax", 9);
+    double diff = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+    {
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+        {
+            for (int dj3 = std::abs(dj1 - dj2); dj3 <= dj1 + dj2; dj3 += 2)
+            {
+                for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                {
+                    for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                    {
+                        diff += std::abs(sw.f3j(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2) -
+                                         wigner_3j(dj1, dj2, dj3, dm1, dm2, -dm1 - dm2));
+                        diff += std::abs(sw.CG(dj1, dj2, dj3, dm1, dm2, dm1 + dm2) -
+                                         CG(dj1, dj2, dj3, dm1, dm2, dm1 + dm2));
+                    }
+                    diff += std::abs(sw.dfunc(dj1, dm1, -dm1, 0.3) - dfunc(dj1, dm1, -dm1, 0.3));
+                }
+                diff += std::abs(sw.CG0(dj1, dj2, dj3) - CG0(dj1, dj2, dj3));
+                for (int dj4 = 0; dj4 <= N; dj4 += 3)
+                {
+                    for (int dj5 = 0; dj5 <= N; ++dj5)
+                    {
+                        diff += std::abs(sw.f6j(dj1, dj2, dj3, dj4, dj5, dj3) -
+                                         wigner_6j(dj1, dj2, dj3, dj4, dj5, dj3));
+                        diff += std::abs(sw.f9j(dj1, dj2, dj3, dj4, dj5, dj3, dj1, dj2, dj2) -
+                                         wigner_9j(dj1, dj2, dj3, dj4, dj5, dj3, dj1, dj2, dj2));
+                    }
+                }
+            }
+        }
+    }
+    sw.reserve(2, "Moshinsky", 0);
+    for (int idx = 0; idx < 13; ++idx)
+    {
+        Moshinsky_case m = Moshinsky_test_set[idx];
+        double x = sw.Moshinsky(m.N, m.L, m.n, m.l, m.n1, m.l1, m.n2, m.l2, m.Lambda, 0.5);
+        diff += std::abs(x - Moshinsky(m.N, m.L, m.n, m.l, m.n1, m.l1, m.n2, m.l2, m.Lambda, 0.5));
+    }
+    std::cout << "test sqrt table, diff = " << diff << std::endl;
+}
+
+// the batch symbols against the scalar ones, with invalid arguments and a table that grows on the fly
+template <typename T>
+double test_batch_engine(int N)
+{
+    std::mt19937 gen(7);
+    auto rand = [&gen](int low, int high) { return std::uniform_int_distribution<int>(low, high)(gen); };
+    const int M = 100003;
+    std::vector<int> args[6];
+    for (int i = 0; i < M; ++i)
+    {
+        const int dj1 = rand(-1, N), dj2 = rand(0, N);
+        const int dj3 = rand(std::abs(dj1 - dj2) - 1, dj1 + dj2 + 1);
+        const int dm1 = rand(-dj1 - 1, dj1 + 1), dm2 = rand(-dj2, dj2);
+        const int dm3 = rand(0, 9) == 0 ? rand(-std::abs(dj3), std::abs(dj3)) : dm1 + dm2;
+        for (int a : {0, 1, 2, 3, 4, 5})
+            args[a].push_back(a == 0 ? dj1 : a == 1 ? dj2 : a == 2 ? dj3 : a == 3 ? dm1 : a == 4 ? dm2 : dm3);
+    }
+    BasicWignerSymbols<T> w;
+    w.set_reserve_mode(ReserveMode::grow);
+    std::vector<wigner_result_t<T>> out(M);
+    w.CG(M, args[0].data(), args[1].data(), args[2].data(), args[3].data(), args[4].data(), args[5].data(),
+         out.data());
+    double diff = 0;
+    for (int i = 0; i < M; ++i)
+        diff += std::abs(double(out[i] - w.CG(args[0][i], args[1][i], args[2][i], args[3][i], args[4][i], args[5][i])));
+    for (int i = 0; i < M; ++i)
+        args[5][i] = -args[5][i];
+    w.f3j(M, args[0].data(), args[1].data(), args[2].data(), args[3].data(), args[4].data(), args[5].data(),
+          out.data());
+    for (int i = 0; i < M; ++i)
+        diff +=
+            std::abs(double(out[i] - w.f3j(args[0][i], args[1][i], args[2][i], args[3][i], args[4][i], args[5][i])));
+    return diff;
+}
+
+void test_batch()
+{
+    double diff = test_batch_engine<double>(120) + test_batch_engine<long double>(40);
+    std::cout << "test batch, diff = " << diff << std::endl;
+}
+
+// the CG blocks from the m recursions against the single coefficients
+void test_CG_block()
+{
+    const int N = 24;
+    wigner_init(N, "Jmax", 3);
+    std::vector<double> block((N + 1) * (N + 1));
+    double diff = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+    {
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+        {
+            for (int dj3 = std::abs(dj1 - dj2) - 1; dj3 <= dj1 + dj2 + 1; ++dj3)
+            {
+                wigner.CG_block(dj1, dj2, dj3, block.data());
+                for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+                {
+                    for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                    {
+                        const double x = block[(dj1 + dm1) / 2 * (dj2 + 1) + (dj2 + dm2) / 2];
+                        diff += std::abs(x - CG(dj1, dj2, dj3, dm1, dm2, dm1 + dm2));
+                    }
+                }
+            }
+        }
+    }
+    // a nearly stretched large triad runs deep into the classically forbidden region, its squares sum to 2j3+1
+    std::vector<double> large(1501 * 1501);
+    wigner.CG_block(1500, 1500, 2998, large.data());
+    double norm = 0;
+    for (const double x : large)
+        norm += x * x;
+    diff += std::isfinite(norm) ? std::abs(norm / 2999 - 1) : 1;
+    std::cout << "test CG block, diff = " << diff << std::endl;
+}
+
+// the 3j symbols of all `dj3` from the recursion against the single symbols
+void test_3j_range()
+{
+    const int N = 24;
+    wigner_init(N, "Jmax", 3);
+    std::vector<double> range(N + 1);
+    double diff = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+    {
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+        {
+            for (int dm1 = -dj1; dm1 <= dj1; dm1 += 2)
+            {
+                for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                {
+                    const int count = wigner.f3j_range(dj1, dj2, dm1, dm2, range.data());
+                    const int dj3min = std::max(std::abs(dj1 - dj2), std::abs(dm1 + dm2));
+                    diff += std::abs(count - ((dj1 + dj2 - dj3min) / 2 + 1));
+                    for (int k = 0; k < count; ++k)
+                        diff += std::abs(range[k] - wigner_3j(dj1, dj2, dj3min + 2 * k, dm1, dm2, -dm1 - dm2));
+                }
+            }
+        }
+    }
+    // rows with long classically forbidden runs, the sum rule sum (2j3+1)(3j)^2 = 1 holds for each
+    const int rows[][4] = {{1000, 1128, 396, -1126}, {3000, 3000, 2990, -2000}};
+    for (const auto &row : rows)
+    {
+        std::vector<double> large(row[0] + row[1] + 1);
+        const int count = wigner.f3j_range(row[0], row[1], row[2], row[3], large.data());
+        const int dj3min = std::max(std::abs(row[0] - row[1]), std::abs(row[2] + row[3]));
+        double norm = 0;
+        for (int k = 0; k < count; ++k)
+            norm += (dj3min + 2 * k + 1) * large[k] * large[k];
+        diff += std::isfinite(norm) ? std::abs(norm - 1) : 1;
+    }
+    std::cout << "test 3j range, diff = " << diff << std::endl;
+}
+
+// the 6j symbols of all `dj1` from the recursion against the single symbols, then two large rows of neighbouring `j4`
+// are orthogonal, `sum (2j1+1) sqrt((2j4+1)(2j4'+1)) f f' = 0`
+void test_6j_range()
+{
+    const int N = 16;
+    wigner_init(N, "Jmax", 6);
+    std::vector<double> range(N + 1);
+    double diff = 0;
+    for (int dj2 = 0; dj2 <= N; ++dj2)
+        for (int dj3 = 0; dj3 <= N; ++dj3)
+            for (int dj4 = 0; dj4 <= N; ++dj4)
+                for (int dj5 = 0; dj5 <= N; ++dj5)
+                    for (int dj6 = 0; dj6 <= N; ++dj6)
+                    {
+                        const int count = wigner.f6j_range(dj2, dj3, dj4, dj5, dj6, range.data());
+                        const int dj1min = std::max(std::abs(dj2 - dj3), std::abs(dj5 - dj6));
+                        for (int dj1 = 0; dj1 <= 2 * N; ++dj1)
+                        {
+                            const int k = (dj1 - dj1min) / 2;
+                            const bool inside = dj1 >= dj1min && k < count && (dj1 - dj1min) % 2 == 0;
+                            diff += std::abs((inside ? range[k] : 0) - wigner_6j(dj1, dj2, dj3, dj4, dj5, dj6));
+                        }
+                    }
+    std::vector<double> f(1402), g(1402);
+    for (const auto &row : {std::array<int, 5>{800, 1000, 600, 900, 700}, {1200, 1200, 1000, 1400, 1400}})
+    {
+        const int count = wigner.f6j_range(row[0], row[1], row[2], row[3], row[4], f.data());
+        wigner.f6j_range(row[0], row[1], row[2] + 2, row[3], row[4], g.data());
+        const int dj1min = std::max(std::abs(row[0] - row[1]), std::abs(row[3] - row[4]));
+        double dot = 0;
+        for (int k = 0; k < count; ++k)
+            dot += (dj1min + 2 * k + 1) * f[k] * g[k];
+        dot *= std::sqrt((row[2] + 1.0) * (row[2] + 3.0));
+        diff += std::isfinite(dot) ? std::abs(dot) : 1;
+    }
+    std::cout << "test 6j range, diff = " << diff << std::endl;
+}
+
+// the Regge symmetric table against the symbols, grown once, with the symbols beyond it and invalid arguments
+void test_regge_table()
+{
+    const int N = 24;
+    wigner_init(N, "Jmax", 3);
+    Regge3jTable<double> table;
+    table.reserve(10);
+    table.reserve(20);
+    double diff = 0;
+    for (int dj1 = 0; dj1 <= N; ++dj1)
+    {
+        for (int dj2 = 0; dj2 <= N; ++dj2)
+        {
+            for (int dj3 = 0; dj3 <= N; ++dj3)
+            {
+                for (int dm1 = -dj1 - 1; dm1 <= dj1 + 1; ++dm1)
+                {
+                    for (int dm2 = -dj2; dm2 <= dj2; dm2 += 2)
+                    {
+                        const int dm3 = -dm1 - dm2;
+                        diff += std::abs(table.f3j(dj1, dj2, dj3, dm1, dm2, dm3) -
+                                         wigner.f3j(dj1, dj2, dj3, dm1, dm2, dm3));
+                        diff += std::abs(table.CG(dj1, dj2, dj3, dm1, dm2, -dm3) -
+                                         wigner.CG(dj1, dj2, dj3, dm1, dm2, -dm3));
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "test Regge table, Jmax = " << table.Jmax() << ", memory = " << table.memory()
+              << " bytes, diff = " << diff << std::endl;
+}
+
+// CG0 and its rows from the table against the formula, inside and beyond the table, and of a copy
+void test_CG0_table()
+{
+    const int N = 20;
+    WignerSymbols plain;
+    plain.reserve(2 * N, "Jmax", 3);
+    WignerSymbols w;
+    w.reserve(6, "CG0", 0);
+    w.reserve(12, "CG0", 0);
+    w.reserve(2 * N, "Jmax", 3);
+    const WignerSymbols copy(w);
+    std::vector<double> row(N + 1);
+    double diff = 0;
+    for (int j1 = -1; j1 <= N; ++j1)
+    {
+        for (int j2 = -1; j2 <= N; ++j2)
+        {
+            for (int j3 = -1; j3 <= 2 * N + 1; ++j3)
+            {
+                const double x = plain.CG0(j1, j2, j3);
+                diff += std::abs(w.CG0(j1, j2, j3) - x) + std::abs(copy.CG0(j1, j2, j3) - x);
+            }
+            const int count = w.CG0_range(j1, j2, row.data());
+            diff += std::abs(count - (j1 < 0 || j2 < 0 ? 0 : std::min(j1, j2) + 1));
+            for (int k = 0; k < count; ++k)
+                diff += std::abs(row[k] - plain.CG0(j1, j2, std::abs(j1 - j2) + 2 * k));
+        }
+    }
+    std::cout << "test CG0 table, jmax = " << w.CG0_table().jmax() << ", memory = " << w.CG0_table().memory()
+              << " bytes, diff = " << diff << std::endl;
+}
+
+// the compile time tables of small fixed spins against `CG`, also out of range and with wrong parity
+template <int dj1, int dj2>
+double _diff_CGfixed()
+{
+    double diff = 0;
+    for (int dm1 = -dj1 - 2; dm1 <= dj1 + 2; ++dm1)
+        for (int dm2 = -dj2 - 2; dm2 <= dj2 + 2; ++dm2)
+            for (int dJ = -1; dJ <= dj1 + dj2 + 2; ++dJ)
+                diff += std::abs(CGfixed<dj1, dj2>(dm1, dm2, dJ) - CG(dj1, dj2, dJ, dm1, dm2, dm1 + dm2));
+    return diff;
+}
+
+template <int dj1, int dj2, int dj3>
+double _diff_CG3fixed()
+{
+    double diff = 0;
+    for (int dm1 = -dj1 - 1; dm1 <= dj1 + 1; ++dm1)
+        for (int dm2 = -dj2 - 1; dm2 <= dj2 + 1; ++dm2)
+            for (int dm3 = -dj3 - 1; dm3 <= dj3 + 1; ++dm3)
+                for (int dJ12 = -1; dJ12 <= dj1 + dj2 + 1; ++dJ12)
+                    for (int dJ = -1; dJ <= dj1 + dj2 + dj3 + 1; ++dJ)
+                    {
+                        const int dM12 = dm1 + dm2;
+                        const double x = CG(dj1, dj2, dJ12, dm1, dm2, dM12) * CG(dJ12, dj3, dJ, dM12, dm3, dM12 + dm3);
+                        diff += std::abs(CG3fixed<dj1, dj2, dj3>(dm1, dm2, dm3, dJ12, dJ) - x);
+                    }
+    return diff;
+}
+
+void test_CGfixed()
+{
+    static_assert(CGfixed<1, 1>(1, 1, 2) == 1.0, "CGfixed is a constant expression");
+    double diff = _diff_CGfixed<0, 3>() + _diff_CGfixed<1, 1>() + _diff_CGfixed<2, 3>() + _diff_CGfixed<3, 3>() +
+                  _diff_CGfixed<4, 2>() + _diff_CGfixed<3, 8>();
+    diff += _diff_CG3fixed<1, 1, 1>() + _diff_CG3fixed<2, 2, 1>() + _diff_CG3fixed<3, 3, 3>();
+    for (int dm1 = -2; dm1 <= 2; ++dm1)
+        for (int dm2 = -2; dm2 <= 2; ++dm2)
+            for (int S = -1; S <= 2; ++S)
+            {
+                diff += std::abs(CGfixed<1, 1>(dm1, dm2, 2 * S) - CGspin(dm1, dm2, S));
+                for (int dm3 = -2; dm3 <= 2; ++dm3)
+                    for (int dS = -1; dS <= 4; ++dS)
+                        diff += std::abs(CG3fixed<1, 1, 1>(dm1, dm2, dm3, 2 * S, dS) - CG3spin(dm1, dm2, dm3, S, dS));
+            }
+    std::cout << "test CGfixed, diff = " << diff << std::endl;
+}
+
+// the blocks against `CG`, and `apply` and `transform` against the dense matrix of the basis change
+void test_coupling_matrix()
+{
+    WignerSymbols w;
+    w.reserve(20, "Jmax", 3);
+    double diff = 0;
+    const int pairs[][2] = {{0, 0}, {0, 5}, {1, 1}, {3, 4}, {5, 2}, {6, 6}, {9, 4}};
+    for (auto &p : pairs)
+    {
+        const int dj1 = p[0], dj2 = p[1];
+        const CouplingMatrix<double> U(dj1, dj2);
+        const int n = U.dim();
+        std::vector<double> dense(n * n, 0);
+        for (int dJ = std::abs(dj1 - dj2); dJ <= dj1 + dj2 + 2; ++dJ)
+            for (int dm1 = -dj1 - 1; dm1 <= dj1 + 1; ++dm1)
+                for (int dm2 = -dj2 - 1; dm2 <= dj2 + 1; ++dm2)
+                {
+                    const double x = w.CG(dj1, dj2, dJ, dm1, dm2, dm1 + dm2);
+                    diff += std::abs(U(dJ, dm1, dm2) - x);
+                    if (x != 0)
+                        dense[U.coupled_index(dJ, dm1 + dm2) * n + U.product_index(dm1, dm2)] = x;
+                }
+        // `a` is also read as `n` rows of 3 vectors
+        std::vector<double> a(n * n + 3 * n), b(n * n), c(n * n), y(3 * n), x(3 * n);
+        for (int i = 0; i < n * n + 3 * n; ++i)
+            a[i] = std::sin(1.0 + i);
+        // 3 vectors at once, then all of `a` as an operator
+        U.apply(a.data(), y.data(), 3);
+        U.apply_transpose(y.data(), x.data(), 3);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < 3; ++j)
+            {
+                double s = 0;
+                for (int k = 0; k < n; ++k)
+                    s += dense[i * n + k] * a[k * 3 + j];
+                diff += std::abs(y[i * 3 + j] - s) + std::abs(x[i * 3 + j] - a[i * 3 + j]);
+            }
+        U.transform(a.data(), b.data());
+        U.transform_back(b.data(), c.data());
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+            {
+                double s = 0;
+                for (int k = 0; k < n; ++k)
+                    for (int l = 0; l < n; ++l)
+                        s += dense[i * n + k] * a[k * n + l] * dense[j * n + l];
+                diff += std::abs(b[i * n + j] - s) + std::abs(c[i * n + j] - a[i * n + j]);
+            }
+    }
+    std::cout << "test coupling matrix, diff = " << diff << std::endl;
+}
+
+// the recoupling matrix of three angular momenta against the scalar 6j symbols, in both layouts, and its orthogonality
+void test_recoupling_matrix()
+{
+    WignerSymbols w;
+    w.reserve(40, "Jmax", 6);
+    double diff = 0;
+    const int args[][4] = {{0, 0, 0, 0}, {1, 1, 1, 1}, {2, 3, 4, 5}, {4, 4, 4, 2},
+                           {9, 6, 7, 10}, {7, 7, 7, 21}, {8, 5, 3, 1}, {30, 24, 20, 36}};
+    RecouplingMatrix<double> C(0, 0, 0, 0, true);
+    for (auto &p : args)
+    {
+        const int dj1 = p[0], dj2 = p[1], dj3 = p[2], dJ = p[3];
+        const RecouplingMatrix<double> R(dj1, dj2, dj3, dJ);
+        C.assign(dj1, dj2, dj3, dJ, true);
+        const int n = R.dim();
+        for (int a = 0; a < n; ++a)
+            for (int b = 0; b < n; ++b)
+            {
+                const int dJ12 = R.dJ12min() + 2 * a, dJ23 = R.dJ23min() + 2 * b;
+                const double x = ((dj1 + dj2 + dj3 + dJ) / 2 % 2 ? -1 : 1) * std::sqrt((dJ12 + 1.0) * (dJ23 + 1.0)) *
+                                 w.f6j(dj1, dj2, dJ12, dj3, dJ, dJ23);
+                diff += std::abs(R(dJ12, dJ23) - x) + std::abs(C(dJ12, dJ23) - x);
+                diff += std::abs(R.data()[a * n + b] - C.data()[b * n + a]);
+                double s = 0;
+                for (int k = 0; k < n; ++k)
+                    s += R.data()[a * n + k] * R.data()[b * n + k];
+                diff += std::abs(s - (a == b));
+            }
+        // 2 vectors there and back
+        std::vector<double> x(2 * n), y(2 * n), z(2 * n);
+        for (int i = 0; i < 2 * n; ++i)
+            x[i] = std::sin(1.0 + i);
+        R.apply(x.data(), y.data(), 2);
+        C.apply_transpose(y.data(), z.data(), 2);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < 2; ++j)
+            {
+                double s = 0;
+                for (int k = 0; k < n; ++k)
+                    s += R.data()[i * n + k] * x[k * 2 + j];
+                diff += std::abs(y[i * 2 + j] - s) + std::abs(z[i * 2 + j] - x[i * 2 + j]);
+            }
+    }
+    // an odd sum and a `J` beyond `j1 + j2 + j3`
+    const bool empty = RecouplingMatrix<double>(1, 1, 1, 2).dim() == 0 &&
+                       RecouplingMatrix<double>(1, 1, 2, 8).dim() == 0;
+    std::cout << "test recoupling matrix, diff = " << diff << (empty ? "" : ", wrong dim") << std::endl;
+}
+
+// Gaunt coefficients against the two exact 3j symbols, the table against `Gaunt`, and the product of two expansions
+// against the product of their values at a few points
+void test_Gaunt()
+{
+    const int lmax = 6;
+    WignerSymbols w;
+    w.reserve(2 * lmax, "Jmax", 3);
+    const GauntTable<double> table(lmax);
+    const double pi = 3.141592653589793;
+    double diff = 0;
+    for (int l1 = -1; l1 <= lmax + 1; ++l1)
+        for (int l2 = -1; l2 <= lmax + 1; ++l2)
+            for (int l3 = -1; l3 <= 2 * lmax + 3; ++l3)
+                for (int m1 = -l1 - 1; m1 <= l1 + 1; ++m1)
+                    for (int m2 = -l2 - 1; m2 <= l2 + 1; ++m2)
+                        for (int m3 = -l3 - 1; m3 <= l3 + 1; ++m3)
+                        {
+                            double x = 0;
+                            if (l1 >= 0 && l2 >= 0 && l3 >= 0)
+                                x = std::sqrt((2 * l1 + 1) * (2 * l2 + 1) * (2 * l3 + 1) / (4 * pi)) *
+                                    gsl_sf_coupling_3j(2 * l1, 2 * l2, 2 * l3, 0, 0, 0) *
+                                    gsl_sf_coupling_3j(2 * l1, 2 * l2, 2 * l3, 2 * m1, 2 * m2, 2 * m3);
+                            diff += std::abs(w.Gaunt(l1, l2, l3, m1, m2, m3) - x);
+                            if (l1 <= lmax && l2 <= lmax)
+                                diff += std::abs(table(l1, l2, l3, m1, m2, m3) - x);
+                        }
+    // `Y_{lm}(theta, 0)` from the d functions, `sqrt((2l+1)/(4pi)) d^l_{m0}(theta)`
+    auto Y = [&w, pi](int l, int m, double theta, double phi) {
+        const double x = std::sqrt((2 * l + 1) / (4 * pi)) * w.dfunc(2 * l, 2 * m, 0, theta);
+        return std::complex<double>(x * std::cos(m * phi), x * std::sin(m * phi));
+    };
+    const int n = (lmax + 1) * (lmax + 1), N = (2 * lmax + 1) * (2 * lmax + 1);
+    std::vector<double> a(n), b(n), c(N);
+    for (int i = 0; i < n; ++i)
+        a[i] = std::sin(1.0 + i), b[i] = std::cos(2.0 + 3 * i);
+    table.product(a.data(), b.data(), c.data());
+    for (double theta : {0.3, 1.2, 2.5})
+    {
+        for (double phi : {0.0, 0.7, 4.0})
+        {
+            std::complex<double> f = 0, g = 0, h = 0;
+            for (int l = 0; l <= 2 * lmax; ++l)
+                for (int m = -l; m <= l; ++m)
+                {
+                    if (l <= lmax)
+                        f += a[table.lm(l, m)] * Y(l, m, theta, phi), g += b[table.lm(l, m)] * Y(l, m, theta, phi);
+                    h += c[table.lm(l, m)] * Y(l, m, theta, phi);
+                }
+            diff += std::abs(f * g - h);
+        }
+    }
+    std::cout << "test Gaunt, table size = " << table.size() << ", memory = " << table.memory()
+              << " bytes, diff = " << diff << std::endl;
+}
+
+// The cached 6j symbols against `wigner_6j`, from 4 threads at once and with a table too small for them, and the keys
+// of a column swap, a row swap in two columns and a Regge transform of each valid symbol.
+void test_6j_cache()
+{
+    const int N = 12;
+    wigner_init(N, "Jmax", 6);
+    Wigner6jCache<double> cache;
+    Wigner6jCache<double> tiny(16);
+    auto run = [N](const Wigner6jCache<double> &c, double &diff, int &wrong) {
+        std::uint64_t valid = 0;
+        for (int dj1 = 0; dj1 <= N; ++dj1)
+            for (int dj2 = 0; dj2 <= N; ++dj2)
+                for (int dj3 = 0; dj3 <= N; ++dj3)
+                    for (int dj4 = 0; dj4 <= N; ++dj4)
+                        for (int dj5 = 0; dj5 <= N; ++dj5)
+                            for (int dj6 = 0; dj6 <= N; ++dj6)
+                            {
+                                const double x = c.f6j(dj1, dj2, dj3, dj4, dj5, dj6);
+                                diff += std::abs(x - wigner_6j(dj1, dj2, dj3, dj4, dj5, dj6));
+                                const auto key = Wigner6jCache<double>::key(dj1, dj2, dj3, dj4, dj5, dj6);
+                                if (key == Wigner6jCache<double>::invalid_key)
+                                    continue;
+                                ++valid;
+                                const int s = (dj2 + dj3 + dj5 + dj6) / 2;
+                                wrong += key != Wigner6jCache<double>::key(dj2, dj1, dj3, dj5, dj4, dj6);
+                                wrong += key != Wigner6jCache<double>::key(dj4, dj5, dj3, dj1, dj2, dj6);
+                                wrong += key != Wigner6jCache<double>::key(dj1, s - dj6, s - dj5, dj4, s - dj3,
+                                                                           s - dj2);
+                            }
+        return valid;
+    };
+    double diffs[4] = {};
+    int wrongs[4] = {};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&, t] { run(cache, diffs[t], wrongs[t]); });
+    for (auto &t : threads)
+        t.join();
+    double diff = diffs[0] + diffs[1] + diffs[2] + diffs[3];
+    int wrong = wrongs[0] + wrongs[1] + wrongs[2] + wrongs[3];
+    const std::uint64_t valid = run(tiny, diff, wrong);
+    const auto stats = cache.stats();
+    wrong += stats.lookups() != 4 * valid || stats.sampled == 0;
+    wrong += tiny.size() > tiny.capacity();
+    std::cout << "test 6j cache, size = " << cache.size() << ", hit rate = " << stats.hit_rate()
+              << ", diff = " << diff << ", wrong = " << wrong << std::endl;
+}
+
+// the dense 6j tables of half integer and integer single particle `j` against `wigner_6j`, with the arguments beyond
+// them and the zero symbols
+void test_6j_table()
+{
+    const int N = 12;
+    wigner_init(N, "Jmax", 6);
+    double diff = 0;
+    for (int djmax : {9, 8})
+    {
+        const Wigner6jTable<double> table(djmax);
+        for (int dja = 0; dja <= N; ++dja)
+            for (int djb = 0; djb <= N; ++djb)
+                for (int dJ = -1; dJ <= N; ++dJ)
+                    for (int djc = 0; djc <= N; ++djc)
+                        for (int djd = 0; djd <= N; ++djd)
+                            for (int dJp = -1; dJp <= N; ++dJp)
+                                diff += std::abs(table.f6j(dja, djb, dJ, djc, djd, dJp) -
+                                                 wigner_6j(dja, djb, dJ, djc, djd, dJp));
+        diff += table.memory() != Wigner6jTable<double>::memory(djmax);
+    }
+    std::cout << "test 6j table, size = " << Wigner6jTable<double>::size(9) << ", diff = " << diff << std::endl;
+}
+
+// the triad bitmap against the direct check, inside, on the border of and outside the bitmap
+void test_triangle_table()
+{
+    WignerSymbols w;
+    w.reserve(80, "triad", 0);
+    TriangleTable big;
+    big.reserve(1000);
+    int wrong = 0;
+    for (int dj1 = -3; dj1 <= 300; ++dj1)
+    {
+        for (int dj2 = -3; dj2 <= 300; ++dj2)
+        {
+            for (int dj3 = -3; dj3 <= 300; ++dj3)
+            {
+                const bool ok = WignerSymbols::check_couple(dj1, dj2, dj3);
+                wrong += (w.triad(dj1, dj2, dj3) != ok) + (big(dj1, dj2, dj3) != ok);
+            }
+        }
+    }
+    std::cout << "test triangle table, bitmap djmax = " << w.triangle_table().djmax() << ", " << big.djmax()
+              << ", wrong = " << wrong << std::endl;
+}
+
 int main(int argc, char const *argv[])
 {
     test_3j();
@@ -288,7 +1237,33 @@ int main(int argc, char const *argv[])
     test_6j();
     test_9j();
     test_Moshinsky();
+    test_dfunc();
     test_CGspin();
     test_lsjj();
+    test_closed_forms();
+    test_concurrent_reserve();
+    test_reserve_mode();
+    test_table_policy();
+    test_sqrt_table();
+    test_triangle_table();
+    test_batch();
+    test_CG_block();
+    test_3j_range();
+    test_6j_range();
+    test_regge_table();
+    test_CG0_table();
+    test_CGfixed();
+    test_coupling_matrix();
+    test_recoupling_matrix();
+    test_Gaunt();
+    test_6j_cache();
+    test_6j_table();
+    test_xdouble();
+    test_factorial_table();
+    test_precision<float>("float");
+    test_precision<long double>("long double");
+#ifdef __SIZEOF_FLOAT128__
+    test_precision<__float128>("__float128");
+#endif
     return 0;
 }